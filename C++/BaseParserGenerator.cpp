@@ -16,6 +16,7 @@ BaseParserGenerator::GrammarParser::GrammarParser(BaseParserGenerator *p, char *
     parser = p;
     curpos = grammarConfig;
     prevpos = curpos;
+    lines.reset(grammarConfig);
 }
 
 //Convert gtoken enum into string form
@@ -27,13 +28,13 @@ const char* BaseParserGenerator::GrammarParser::gtokenName(Gtoken::Gtoken gtoken
 }
 //Error for unexpected token
 void BaseParserGenerator::GrammarParser::error(Gtoken::Gtoken gtoken){
-    std::cerr << "Grammar config error at line " << lexer.tokenLine << " position " << lexer.tokenCol << 
+    std::cerr << "Grammar config error at line " << lines.line(curpos) << " position " << lines.column(curpos)+1 << 
     " : Unexpected token " << gtokenName((Gtoken::Gtoken)lexer.tokenID) << " encountered instead of token " << gtokenName(gtoken) << "\n";
     throw GrammarConfigError("Grammar Config Error");
 }
 //Error with custom message
 void BaseParserGenerator::GrammarParser::error(char *message){
-    std::cerr << "Grammar config error at line " << lexer.tokenLine << " position " << lexer.tokenCol << " : " << message << '\n';
+    std::cerr << "Grammar config error at line " << lines.line(curpos) << " position " << lines.column(curpos)+1 << " : " << message << '\n';
     throw GrammarConfigError("Grammar Config Error");
 }
 
@@ -42,7 +43,7 @@ void BaseParserGenerator::GrammarParser::next(){
     do{
         prevpos = curpos;
         curpos = lexer.lex(curpos);
-        //std::cout << lexer.tokenID << ' ' << lexer.tokenCol << ' ' << (*prevpos) << '\n';
+        //std::cout << lexer.tokenID << ' ' << (*prevpos) << '\n';
     } while((lexer.tokenID == 0 || lexer.tokenID == 1) && prevpos != curpos);
     // Quits when empty token is encountered, as it signifies an incorrect input
 }
@@ -248,19 +249,88 @@ int BaseParserGenerator::ruleStart(int symbol){
 
 //Return the token or char
 int BaseParserGenerator::next(){
+    //Pre-lexed tokens have already had ignored tokens removed. Running out of them is the end of input,
+    //which is counted as one more position like the \0 of a string input
+    if (stream != NULL){
+        if (streamPos >= stream->size()){
+            prevpos = (char*)stream->base + stream->length;
+            curpos = prevpos;
+            pastEnd = true;
+            return 0;
+        }
+        prevpos = (char*)stream->base + stream->starts[streamPos];
+        curpos = prevpos + stream->lengths[streamPos];
+        int id = stream->ids[streamPos];
+        streamPos++;
+        if (id < 0)
+            return (int)(*prevpos);
+        return id + NumOfChars;
+    }
     //Skip all ignored tokens. Stop when empty token is encountered
     do {
         prevpos = curpos;
-        curpos = lexptr->lex(curpos);
-    } while(prevpos!=curpos && tokenIgnore[lexptr->tokenID]);
+        if (input != NULL)
+            curpos = lexptr->lex(*input, prevpos, lexContext);
+        else curpos = lexptr->lex(curpos, lexContext, inputEnd);
+    } while(prevpos!=curpos && tokenIgnore[lexContext.tokenID]);
     //If no actual token is available or if token is empty, advance the input by 1 and return the char
-    if (lexptr->tokenID < 0 || prevpos==curpos){
+    if (lexContext.tokenID < 0 || prevpos==curpos){
+        //Bounded input has no \0 to return, so the end is returned in its place without going past it
+        if (prevpos == inputEnd){
+            pastEnd = true;
+            return 0;
+        }
         curpos++;
-        lexptr->tokenCol++;
         return (int)(*prevpos);
     } 
     //Otherwise, return the incremented token number
-    return lexptr->tokenID + NumOfChars;
+    return lexContext.tokenID + NumOfChars;
+}
+
+//Parse will run the lexer on the string as it goes
+void BaseParserGenerator::setInput(char *input){
+    curpos = input;
+    prevpos = input;
+    stream = NULL;
+    this->input = NULL;
+    inputEnd = NULL;
+    lines.reset(input);
+    pastEnd = false;
+    lexContext.reset();
+}
+
+//Parse will lex the string up to end. The string is never written to
+void BaseParserGenerator::setInput(const char *begin, const char *end){
+    setInput((char*)begin);
+    inputEnd = end;
+}
+
+//Parse will lex the stream as it reads it. Nothing is read until the first token is needed
+void BaseParserGenerator::setInput(InputStream &input){
+    curpos = input.begin();
+    prevpos = curpos;
+    stream = NULL;
+    this->input = &input;
+    inputEnd = NULL;
+    pastEnd = false;
+    lexContext.reset();
+}
+
+//Parse will read tokens from the stream. The stream has to outlive the parse
+void BaseParserGenerator::setInput(const TokenStream &tokens){
+    curpos = (char*)tokens.base;
+    prevpos = curpos;
+    stream = &tokens;
+    streamPos = 0;
+    input = NULL;
+    inputEnd = NULL;
+    lines.reset(tokens.base);
+    pastEnd = false;
+    lexContext.reset();
+}
+
+TokenStream BaseParserGenerator::tokenize(const char *begin, const char *end){
+    return lexptr->tokenizeAll(begin, end, tokenIgnore);
 }
 
 //Get contents of current token
@@ -283,12 +353,16 @@ bool BaseParserGenerator::isTerminal(int symbol){
     return symbol < tokenNum;
 }
 
-//Return lexer's column and line numbers
-int BaseParserGenerator::colNum(){
-    return lexptr->tokenCol-1;
+//Lines and columns are counted back from the end of the current token. Input streams count the lines they have dropped themselves
+long long BaseParserGenerator::colNum(){
+    if (input != NULL)
+        return input->column(curpos);
+    return lines.column(curpos) + pastEnd;
 }
-int BaseParserGenerator::lineNum(){
-    return lexptr->tokenLine;
+long long BaseParserGenerator::lineNum(){
+    if (input != NULL)
+        return input->line(curpos);
+    return lines.line(curpos);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -2,6 +2,7 @@
 #define BASEPARSERGENERATOR_H
 
 #include "Lexer.h"
+#include "LineIndex.h"
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -62,6 +63,8 @@ private:
         // Tracks current and previous location in the grammar string so that words can be extracted
         char *curpos;
         char *prevpos;
+        // Finds the line and column of errors
+        LineIndex lines;
         BaseParserGenerator *parser;
         //Icremented number of rules parsed so far, not productions. Truly initialized once all tokens have been parsed
         int ruleNum = -10000;
@@ -108,7 +111,20 @@ protected:
 
     char * curpos;
     char * prevpos;
+    //The lexer may be shared with other parsers, so the lexing state of this parser is kept separately
     Lexer * lexptr;
+    LexContext lexContext;
+    //Pre-lexed tokens being parsed and the position of the next one. NULL when the lexer is run during the parse
+    const TokenStream * stream = NULL;
+    size_t streamPos = 0;
+    //Input read a chunk at a time and lexed during the parse. NULL when the input is a string or a token stream
+    InputStream * input = NULL;
+    //End of a string input that isn't \0-terminated. NULL when the string ends at \0
+    const char * inputEnd = NULL;
+    //Lines of a string or token stream input, found when lineNum() or colNum() is called
+    LineIndex lines;
+    //Whether next() returned the end of a bounded input or token stream without moving past it like it does past a \0
+    bool pastEnd = false;
 
     //Add the rhs symbols of a production to a stack
     void addProduction(int ruleStart, std::vector<int>& stack, bool reverse);
@@ -116,6 +132,11 @@ protected:
     int nextProduction(int ruleStart);
     //Gets next token number/char. 0 means end of input
     int next();
+    //Point the parse at a new input, either a string or a stream to be lexed during the parse, or a pre-lexed token stream
+    void setInput(char *input);
+    void setInput(const char *begin, const char *end);
+    void setInput(const TokenStream &tokens);
+    void setInput(InputStream &input);
     //Starting position in grammar of a given lhs symbol
     int ruleStart(int symbol);
     //Get contents of current token
@@ -138,6 +159,17 @@ public:
 
     //Reset all internal variables and initiate parse on a new input. Begin the first reduction
     virtual ParseStatus parse(char *input) = 0;
+    //Same as above, except the input has already been lexed, such as by tokenize()
+    virtual ParseStatus parse(const TokenStream &tokens) = 0;
+    //Same as above, reading the input from a stream as the parse goes. Token values are copied out of the stream's buffer,
+    //so only the current token is kept in memory. The stream has to outlive the parse
+    virtual ParseStatus parse(InputStream &input) = 0;
+    //Same as parse(char*) for a string that isn't \0-terminated, such as a mapped file, which is parsed in place.
+    //A \0 inside the input is still read as the end of input
+    virtual ParseStatus parse(const char *begin, const char *end) = 0;
+    virtual ParseStatus parse(std::string_view input) = 0;
+    //Lexes a whole input with the parser's lexer, dropping the tokens the grammar ignores
+    TokenStream tokenize(const char *begin, const char *end);
     //Finish a pending reduction and associate the produced lhs symbol with the reduced value. Begin the next reduction
     //Primary means of advancing the parsing
     virtual ParseStatus reduce(void *reducedValue, bool toDelete) = 0;
@@ -149,10 +181,11 @@ public:
     virtual void *rhsVal(int pos) = 0;
     
     //Returns number of current token, list of expected tokens, and the column/line numbers in case parse fails
+    //The line and column are of the end of the current token. They are worked out from the input when called
     virtual int curToken() = 0;
     virtual std::vector<int> expectedTokens() = 0;
-    int lineNum();
-    int colNum();
+    long long lineNum();
+    long long colNum();
 };
 
 struct ParseValue{
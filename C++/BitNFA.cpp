@@ -0,0 +1,111 @@
+#include "BitNFA.h"
+#include "PositionNFA.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//Index of the lowest set bit of a nonzero word
+static inline int lowestBit(uint64_t word){
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+//A state set is as many words as the automaton needs, rounded up to 1, 2 or 4 so each size has its own unrolled simulation
+regexp::BitNFA::BitNFA(const PositionNFA &positions, const BaseRegexp &re){
+    int states = positions.size();
+    words = 1;
+    while (words*64 < states)
+        words *= 2;
+    int classCount = re.charClasses(classMap);
+    std::vector<int> representative(classCount, -1);
+    for (int c=NumOfChars-1; c>=0; c--)
+        representative[classMap[c]] = c;
+
+    classMasks.assign(classCount*words, 0);
+    followMasks.assign(states*words, 0);
+    acceptMask.assign(words, 0);
+    accepts = positions.accepts;
+    for (int state=0; state<states; state++){
+        const std::bitset<NumOfChars> &transitions = positions.sets[positions.transitionSet[state]];
+        //The \0 class is left empty, since the input ends there
+        for (int cls=1; cls<classCount; cls++){
+            if (transitions[representative[cls]])
+                classMasks[cls*words + state/64] |= (uint64_t)1 << (state%64);
+        }
+        for (int j=positions.followStart[state]; j<positions.followStart[state+1]; j++){
+            int next = positions.follow[j];
+            followMasks[state*words + next/64] |= (uint64_t)1 << (next%64);
+        }
+        if (accepts[state] > -1)
+            acceptMask[state/64] |= (uint64_t)1 << (state%64);
+    }
+}
+
+int regexp::BitNFA::simulate(char* &str, const char* end, bool *hitEnd) const{
+    if (hitEnd != NULL)
+        *hitEnd = false;
+    if (words == 1)
+        return run<1>(str, end, hitEnd);
+    if (words == 2)
+        return run<2>(str, end, hitEnd);
+    return run<4>(str, end, hitEnd);
+}
+
+//Follows the set bits of the current set to build the next one. Accepts at the same char are resolved by the lowest accept value
+template<int W>
+int regexp::BitNFA::run(char* &str, const char* end, bool *hitEnd) const{
+    const uint64_t *classMasks = this->classMasks.data();
+    const uint64_t *followMasks = this->followMasks.data();
+    const uint64_t *acceptMask = this->acceptMask.data();
+    uint64_t cur[W] = {1};
+    ptrdiff_t lastAcceptPos = 0;
+    int lastAcceptState = accepts[0];
+    for (ptrdiff_t i=0; ; i++){
+        //The end of a bounded input is treated the same as \0. The set isn't empty, so more input could change the token
+        if (str+i == end){
+            if (hitEnd != NULL)
+                *hitEnd = true;
+            break;
+        }
+        unsigned char c = str[i];
+        if (c >= NumOfChars)
+            break;
+        uint64_t next[W] = {0};
+        for (int w=0; w<W; w++){
+            for (uint64_t bits = cur[w]; bits != 0; bits &= bits-1){
+                const uint64_t *follow = followMasks + (w*64 + lowestBit(bits))*W;
+                for (int k=0; k<W; k++)
+                    next[k] |= follow[k];
+            }
+        }
+        const uint64_t *mask = classMasks + classMap[c]*W;
+        uint64_t any = 0;
+        uint64_t accepting = 0;
+        for (int k=0; k<W; k++){
+            cur[k] = next[k] & mask[k];
+            any |= cur[k];
+            accepting |= cur[k] & acceptMask[k];
+        }
+        if (any == 0)
+            break;
+        if (accepting != 0){
+            int accept = -1;
+            for (int w=0; w<W; w++){
+                for (uint64_t bits = cur[w] & acceptMask[w]; bits != 0; bits &= bits-1){
+                    int stateAccept = accepts[w*64 + lowestBit(bits)];
+                    if (accept == -1 || stateAccept < accept)
+                        accept = stateAccept;
+                }
+            }
+            lastAcceptPos = i+1;
+            lastAcceptState = accept;
+        }
+    }
+    str += lastAcceptPos;
+    return lastAcceptState;
+}
@@ -0,0 +1,40 @@
+#ifndef BITNFA_H
+#define BITNFA_H
+
+#include "Regexp.h"
+#include <vector>
+#include <cstdint>
+
+namespace regexp{
+    class PositionNFA;
+
+    // Bit-parallel simulation of a small position automaton. The set of current states is a bitset of 1, 2 or 4 64-bit words,
+    // so a step is the union of the follow masks of the current states ANDed with the mask of the char's class.
+    // Needs no scratch space, so it doesn't use a MatchContext
+    class BitNFA{
+    private:
+        // Number of 64-bit words in a state set
+        int words;
+        // States of the position automaton each char class leads into, indexed by class * words
+        std::vector<uint64_t> classMasks;
+        // Follow positions of each state, indexed by state * words
+        std::vector<uint64_t> followMasks;
+        // States with an accept value, and the accept value of each state
+        std::vector<uint64_t> acceptMask;
+        std::vector<int> accepts;
+        unsigned char classMap[NumOfChars];
+
+        template<int W>
+        int run(char* &str, const char* end, bool *hitEnd) const;
+
+    public:
+        // Largest position automaton a bitset can hold
+        static const int MaxStates = 256;
+        // Builds the masks of a position automaton with at most MaxStates states, using the char classes of its regexp
+        BitNFA(const PositionNFA &positions, const BaseRegexp &re);
+        // Runs the automaton on a string input, obeying maximal munch. Same contract as BaseRegexp::simulate
+        int simulate(char* &str, const char* end = NULL, bool *hitEnd = NULL) const;
+    };
+}
+
+#endif
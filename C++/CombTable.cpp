@@ -0,0 +1,160 @@
+#include "CombTable.h"
+#include <map>
+#include <algorithm>
+
+//Rows are placed from the one with the most cells down, each at the lowest free base where all of its cells land on empty
+//slots. The search for a row gives up after a bounded # of tries, so tables with many dense rows still pack quickly.
+//The arrays are padded so that every column of the row with the highest base is in bounds.
+//The table is kept dense when a packing with no gaps at all wouldn't be smaller, or when the packing found isn't
+void CombTable::pack(int rows, int columns, const std::function<int(int row, int column)> &cell, const std::vector<int> &rowDefaults){
+    defaults = rowDefaults;
+    this->columns = columns;
+    base.assign(rows, 0);
+    //Columns and values of the cells of each row that aren't the default
+    std::vector<std::vector<int>> cells(rows);
+    size_t count = 0;
+    bool narrow = columns <= INT16_MAX;
+    for (int r=0; r<rows; r++){
+        for (int c=0; c<columns; c++){
+            int value = cell(r, c);
+            narrow = narrow && value >= INT16_MIN && value <= INT16_MAX;
+            if (value != defaults[r]){
+                cells[r].push_back(c);
+                cells[r].push_back(value);
+                count++;
+            }
+        }
+    }
+    wide = !narrow;
+    size_t cellBytes = wide ? sizeof(int32_t) : sizeof(int16_t);
+    size_t denseBytes = (size_t)rows*columns*cellBytes;
+    auto keepDense = [&](){
+        dense = true;
+        base = std::vector<int>();
+        next = std::vector<int16_t>();
+        check = std::vector<int16_t>();
+        wideNext = std::vector<int32_t>();
+        wideCheck = std::vector<int32_t>();
+        if (wide)
+            wideNext.reserve((size_t)rows*columns);
+        else next.reserve((size_t)rows*columns);
+        for (int r=0; r<rows; r++){
+            for (int c=0; c<columns; c++){
+                if (wide)
+                    wideNext.push_back(cell(r, c));
+                else next.push_back(cell(r, c));
+            }
+        }
+    };
+    //Each cell left in takes a slot of next and check, and each row a base
+    if (count*2*cellBytes + rows*sizeof(int) >= denseBytes){
+        keepDense();
+        return;
+    }
+    dense = false;
+    //Value and column of each slot, with -1 for an empty one
+    std::vector<int> slotValues;
+    std::vector<int> slotColumns;
+    std::vector<int> order(rows);
+    for (int r=0; r<rows; r++){
+        order[r] = r;
+    }
+    std::stable_sort(order.begin(), order.end(), [&cells](int x, int y){
+        return cells[x].size() > cells[y].size();
+    });
+
+    //Bases taken so far, and the bases of rows already placed by their cells
+    std::vector<char> usedBase;
+    std::map<std::vector<int>, int> placed;
+    //Next empty slot at or after each slot, with paths shortened as they are followed. Slots past the end are empty
+    std::vector<int> nextFree;
+    auto findFree = [&nextFree](int slot){
+        int root = slot;
+        while (root < nextFree.size() && nextFree[root] != root)
+            root = nextFree[root];
+        while (slot < nextFree.size() && nextFree[slot] != slot){
+            int following = nextFree[slot];
+            nextFree[slot] = root;
+            slot = following;
+        }
+        return root;
+    };
+    int maxBase = 0;
+    const int maxTries = 1024;
+    for (int r : order){
+        auto found = placed.find(cells[r]);
+        if (found != placed.end()){
+            base[r] = found->second;
+            continue;
+        }
+        const std::vector<int> &row = cells[r];
+        //Only bases that put the row's first cell on an empty slot are tried
+        int b = 0;
+        if (row.empty()){
+            while (b < usedBase.size() && usedBase[b])
+                b++;
+        }
+        else for (int slot=findFree(row[0]), tries=0; ; slot=findFree(slot+1), tries++){
+            //Rows too dense to fit in the gaps left are put after every cell placed so far, which is where the search
+            //would end up anyway
+            if (tries == maxTries)
+                slot = std::max((int)slotColumns.size(), row[0]);
+            b = slot - row[0];
+            if (b < usedBase.size() && usedBase[b])
+                continue;
+            bool fits = true;
+            for (int i=2; i<row.size() && fits; i+=2){
+                int other = b + row[i];
+                fits = other >= slotColumns.size() || slotColumns[other] == -1;
+            }
+            if (fits)
+                break;
+        }
+        //Claim the base and the slots of the row's cells
+        if (usedBase.size() <= b)
+            usedBase.resize(b+1, false);
+        usedBase[b] = true;
+        for (int i=0; i<row.size(); i+=2){
+            int slot = b + row[i];
+            if (slotColumns.size() <= slot){
+                for (int j=slotColumns.size(); j<=slot; j++)
+                    nextFree.push_back(j);
+                slotColumns.resize(slot+1, -1);
+                slotValues.resize(slot+1, 0);
+            }
+            slotColumns[slot] = row[i];
+            slotValues[slot] = row[i+1];
+            nextFree[slot] = slot+1;
+        }
+        base[r] = b;
+        maxBase = std::max(maxBase, b);
+        placed[cells[r]] = b;
+    }
+    slotColumns.resize(maxBase + columns, -1);
+    slotValues.resize(maxBase + columns, 0);
+    if (slotColumns.size()*2*cellBytes + rows*sizeof(int) >= denseBytes){
+        keepDense();
+        return;
+    }
+    if (wide){
+        wideNext.assign(slotValues.begin(), slotValues.end());
+        wideCheck.assign(slotColumns.begin(), slotColumns.end());
+        next = std::vector<int16_t>();
+        check = std::vector<int16_t>();
+    }
+    else{
+        next.assign(slotValues.begin(), slotValues.end());
+        check.assign(slotColumns.begin(), slotColumns.end());
+        wideNext = std::vector<int32_t>();
+        wideCheck = std::vector<int32_t>();
+    }
+}
+
+int CombTable::rowDefault(int row) const{
+    return defaults[row];
+}
+
+size_t CombTable::bytes() const{
+    return (base.size() + defaults.size()) * sizeof(int) + (next.size() + check.size()) * sizeof(int16_t) +
+        (wideNext.size() + wideCheck.size()) * sizeof(int32_t);
+}
@@ -0,0 +1,50 @@
+#ifndef COMBTABLE_H
+#define COMBTABLE_H
+
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+// Sparse table packed by row displacement, the way yacc and bison pack their parse tables. Each row has a default value,
+// and the cells that differ from it are laid into one shared array at an offset (base) of the row. check holds the column
+// of the cell in each slot, so a slot only belongs to a row if the column matches. Rows are given distinct bases, except
+// for rows with the same cells, which share one.
+// Tables too dense to gain from packing are kept whole instead, row by row. Either way cells are stored in 16 bits if
+// every value and column fits, and in 32 bits otherwise
+class CombTable{
+private:
+    std::vector<int> base;
+    std::vector<int> defaults;
+    //Slots of a packed table, or every cell of a dense one with check left empty
+    std::vector<int16_t> next;
+    std::vector<int16_t> check;
+    //The same when cells don't fit in 16 bits
+    std::vector<int32_t> wideNext;
+    std::vector<int32_t> wideCheck;
+    bool dense = false;
+    bool wide = false;
+    int columns = 0;
+
+public:
+    //Packs a table of the given size, leaving out the cells equal to their row's default. Keeps it dense if that's smaller
+    void pack(int rows, int columns, const std::function<int(int row, int column)> &cell, const std::vector<int> &rowDefaults);
+    //Value of a cell. Kept in the header so lookups in the parse loops can be inlined. The layout is fixed once packed,
+    //so the branches always go the same way
+    int operator()(int row, int column) const{
+        if (dense){
+            size_t i = (size_t)row*columns + column;
+            return wide ? wideNext[i] : next[i];
+        }
+        int i = base[row] + column;
+        if (wide)
+            return (wideCheck[i] == column) ? wideNext[i] : defaults[row];
+        return (check[i] == column) ? next[i] : defaults[row];
+    }
+    //Default value of a row
+    int rowDefault(int row) const;
+    //# of bytes used by the packed arrays
+    size_t bytes() const;
+};
+
+#endif
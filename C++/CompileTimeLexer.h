@@ -0,0 +1,449 @@
+#ifndef COMPILETIMELEXER_H
+#define COMPILETIMELEXER_H
+
+#include "Regexp.h"
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Compile-time front end for fixed sets of regexps. Needs C++20. The regexps are parsed with the same grammar as
+// RegexpBuilder and determinized while compiling, and the DFA is baked into static constexpr tables. Nothing is built at
+// runtime. A syntax error in a regexp is a compile error
+namespace ct{
+    // Regexp string given as a template argument, such as ct::Lexer<"[a-z]+", "[0-9]+">
+    template<size_t N>
+    struct Pattern{
+        char str[N];
+        constexpr Pattern(const char (&s)[N]){
+            for (size_t i=0; i<N; i++)
+                str[i] = s[i];
+        }
+    };
+
+    // Implementation, mirroring RegexpBuilder and the DFA class with containers that work in constant expressions
+    namespace detail{
+        // Transition bitset of a state. std::bitset isn't constexpr until C++23
+        struct CharSet{
+            uint64_t bits[2] = {0, 0};
+            constexpr void set(int c){
+                bits[c/64] |= (uint64_t)1 << (c%64);
+            }
+            constexpr bool test(int c) const{
+                return (bits[c/64] >> (c%64)) & 1;
+            }
+            constexpr void flip(){
+                bits[0] = ~bits[0];
+                bits[1] = ~bits[1];
+            }
+            constexpr bool none() const{
+                return bits[0] == 0 && bits[1] == 0;
+            }
+        };
+
+        // Same as regexp::State. Edge value of -1 means it doesn't exist; -2 means a dangling edge
+        struct State{
+            CharSet transitions;
+            int edge = -2;
+            int epsilon1 = -1;
+            int epsilon2 = -1;
+        };
+
+        // Port of RegexpBuilder. Syntax errors are thrown, which can't happen in a constant expression, so they fail the build
+        struct Builder{
+            const char* regexp;
+            int pos = 0;
+            std::vector<State>& nfa;
+
+            constexpr Builder(const char* re, std::vector<State>& nfa) : regexp(re), nfa(nfa){}
+
+            constexpr bool notEnd(){
+                return regexp[pos] != 0;
+            }
+            constexpr char next(char c){
+                if (notEnd() && regexp[pos] == c){
+                    pos++;
+                    return regexp[pos-1];
+                }
+                return 0;
+            }
+            constexpr char next(char low, char high){
+                if (notEnd() && regexp[pos] >= low && regexp[pos] <= high){
+                    pos++;
+                    return regexp[pos-1];
+                }
+                return 0;
+            }
+            constexpr void updateFragment(CharSet& transitions, char lower, char upper){
+                for (int i=lower; i<=upper; i++)
+                    transitions.set(i);
+            }
+            constexpr int push(){
+                nfa.push_back(State());
+                return nfa.size()-1;
+            }
+            constexpr void concatenate(int left, int right){
+                if (nfa[left].edge == -2)
+                    nfa[left].edge = right;
+                if (nfa[left].epsilon1 == -2)
+                    nfa[left].epsilon1 = right;
+                if (nfa[left].epsilon2 == -2)
+                    nfa[left].epsilon2 = right;
+            }
+            constexpr void alternate(int& startL, int& endL, int startR, int endR){
+                int root = push();
+                nfa[root].epsilon1 = startL;
+                nfa[root].epsilon2 = startR;
+                int closure = push();
+                concatenate(endL, closure);
+                concatenate(endR, closure);
+                nfa[closure].epsilon1 = -2;
+                startL = root;
+                endL = closure;
+            }
+            constexpr void optional(int& start, int& end){
+                int newStart = push();
+                int newEnd = push();
+                nfa[newStart].epsilon2 = start;
+                nfa[newStart].epsilon1 = newEnd;
+                concatenate(end, newEnd);
+                nfa[newEnd].epsilon1 = -2;
+                start = newStart;
+                end = newEnd;
+            }
+            constexpr void repeating(int& start, int& end){
+                int newEnd = push();
+                nfa[newEnd].epsilon2 = start;
+                nfa[newEnd].epsilon1 = -2;
+                concatenate(end, newEnd);
+                end = newEnd;
+            }
+            constexpr void kleene(int& start, int& end){
+                repeating(start, end);
+                start = end;
+            }
+            constexpr void parseRegexp(int& startL, int& endL){
+                parseConcat(startL, endL);
+                while (next('|')){
+                    int startR = 0, endR = 0;
+                    parseConcat(startR, endR);
+                    alternate(startL, endL, startR, endR);
+                }
+            }
+            constexpr void parseConcat(int& startL, int& endL){
+                if (!notEnd() || regexp[pos]=='|' || regexp[pos]==')'){
+                    startL = endL = push();
+                    nfa[startL].epsilon1 = -2;
+                    return;
+                }
+                parseUnary(startL, endL);
+                while (notEnd() && regexp[pos]!='|' && regexp[pos]!=')'){
+                    int startR = 0, endR = 0;
+                    parseUnary(startR, endR);
+                    concatenate(endL, startR);
+                    endL = endR;
+                }
+            }
+            constexpr void parseUnary(int& start, int& end){
+                parseValue(start, end);
+                if (next('*'))
+                    kleene(start, end);
+                else if (next('+'))
+                    repeating(start, end);
+                else if (next('?'))
+                    optional(start, end);
+            }
+            constexpr void parseValue(int& start, int& end){
+                if (next('(')){
+                    parseRegexp(start, end);
+                    if (!next(')'))
+                        throw "Regex syntax error: missing )";
+                }
+                else{
+                    if (next('['))
+                        start = parseSet();
+                    else
+                        start = parseChar();
+                    end = start;
+                }
+            }
+            constexpr char parseC(){
+                char c = next(1, NumOfChars-1);
+                if (c == 0 || c == '\\' || c == '.' || c == '[' || c == ']' || c == '(' || c == ')')
+                    throw "Regex syntax error: unexpected char";
+                return c;
+            }
+            constexpr int parseChar(){
+                int start = push();
+                CharSet transition;
+                if (next('\\')){
+                    parseSpecial(transition);
+                }
+                else if (next('.')){
+                    updateFragment(transition, 1, '\n');
+                    updateFragment(transition, '\n'+1, NumOfChars-1);
+                }
+                else{
+                    transition.set(parseC());
+                }
+                nfa[start].transitions = transition;
+                return start;
+            }
+            constexpr int parseSet(){
+                int start = push();
+                CharSet transition;
+                bool inverse = false;
+                if (next('^'))
+                    inverse = true;
+                parseElem(transition);
+                while (!next(']'))
+                    parseElem(transition);
+                if (inverse)
+                    transition.flip();
+                nfa[start].transitions = transition;
+                return start;
+            }
+            constexpr void parseElem(CharSet& transition){
+                if (next('\\')){
+                    parseSpecial(transition);
+                }
+                else if (next('.')){
+                    updateFragment(transition, 1, '\n');
+                    updateFragment(transition, '\n'+1, NumOfChars-1);
+                }
+                else{
+                    char c = parseC();
+                    if (next('-')){
+                        char r = parseC();
+                        updateFragment(transition, c, r);
+                    }
+                    else transition.set(c);
+                }
+            }
+            constexpr void parseSpecial(CharSet& transition){
+                char c = next(1, NumOfChars-1);
+                switch(c){
+                    case 0:
+                        transition.set('\\');
+                        break;
+                    case 'd':
+                        updateFragment(transition, '0', '9');
+                        break;
+                    case 'D':
+                        updateFragment(transition, 1, '0'-1);
+                        updateFragment(transition, '9'+1, NumOfChars-1);
+                        break;
+                    case 's':
+                        transition.set(' ');
+                        break;
+                    case 'S':
+                        updateFragment(transition, 1, ' '-1);
+                        updateFragment(transition, ' '+1, NumOfChars-1);
+                        break;
+                    default:
+                        transition.set(c);
+                }
+            }
+            constexpr void build(int &start, int &accept){
+                int end = 0;
+                parseRegexp(start, end);
+                accept = push();
+                concatenate(end, accept);
+            }
+        };
+
+        // Deterministic automaton of a list of regexps, the same as the one regexp::DFA builds before minimization.
+        // State 0 is the starting state, and a missing transition is -1. Accepts at the same length go to the lowest regexp
+        struct Automaton{
+            unsigned char classMap[NumOfChars] = {};
+            int classCount = 0;
+            std::vector<int> transitions;
+            std::vector<int> accepts;
+        };
+
+        // Adds every state reachable by epsilon edges, then sorts the set so equal sets compare equal
+        constexpr void closure(const std::vector<State>& nfa, std::vector<int>& states, std::vector<char>& seen){
+            for (int state : states)
+                seen[state] = 1;
+            for (size_t i=0; i<states.size(); i++){
+                int edges[2] = {nfa[states[i]].epsilon1, nfa[states[i]].epsilon2};
+                for (int next : edges){
+                    if (next >= 0 && !seen[next]){
+                        seen[next] = 1;
+                        states.push_back(next);
+                    }
+                }
+            }
+            for (int state : states)
+                seen[state] = 0;
+            std::sort(states.begin(), states.end());
+        }
+
+        // Builds every regexp into one NFA, starting from the union of their starting states, and runs subset construction
+        constexpr Automaton determinize(const char* const* patterns, int count){
+            std::vector<State> nfa;
+            std::vector<int> starts;
+            std::vector<int> acceptOf;
+            for (int i=0; i<count; i++){
+                Builder builder(patterns[i], nfa);
+                int start = 0, accept = 0;
+                builder.build(start, accept);
+                starts.push_back(start);
+                acceptOf.resize(nfa.size(), -1);
+                acceptOf[accept] = i;
+            }
+
+            //Char classes, refined by every transition bitset. \0 gets class 0 to itself, since it ends the input
+            Automaton dfa;
+            for (int c=1; c<NumOfChars; c++)
+                dfa.classMap[c] = 1;
+            dfa.classCount = 2;
+            for (const State& state : nfa){
+                if (state.transitions.none())
+                    continue;
+                std::vector<int> split(dfa.classCount*2, -1);
+                int newCount = 0;
+                for (int c=0; c<NumOfChars; c++){
+                    int key = dfa.classMap[c]*2 + (c != 0 && state.transitions.test(c));
+                    if (split[key] == -1)
+                        split[key] = newCount++;
+                    dfa.classMap[c] = split[key];
+                }
+                dfa.classCount = newCount;
+            }
+            std::vector<int> representative(dfa.classCount, -1);
+            for (int c=NumOfChars-1; c>=0; c--)
+                representative[dfa.classMap[c]] = c;
+
+            std::vector<std::vector<int>> stateSets;
+            std::vector<char> seen(nfa.size(), 0);
+            //Finds the DFA state of a closed set, making a new one if the set hasn't been seen
+            auto findState = [&](std::vector<int>& states){
+                for (size_t i=0; i<stateSets.size(); i++){
+                    if (stateSets[i] == states)
+                        return (int)i;
+                }
+                int accept = -1;
+                for (int state : states){
+                    if (acceptOf[state] > -1 && (accept == -1 || acceptOf[state] < accept))
+                        accept = acceptOf[state];
+                }
+                stateSets.push_back(states);
+                dfa.accepts.push_back(accept);
+                dfa.transitions.resize(dfa.transitions.size() + dfa.classCount, -1);
+                return (int)stateSets.size()-1;
+            };
+            std::vector<int> states = starts;
+            closure(nfa, states, seen);
+            findState(states);
+            for (size_t cur=0; cur<stateSets.size(); cur++){
+                //The \0 class is never given transitions
+                for (int cls=1; cls<dfa.classCount; cls++){
+                    int c = representative[cls];
+                    states.clear();
+                    for (int state : stateSets[cur]){
+                        int edge = nfa[state].edge;
+                        if (nfa[state].transitions.test(c) && !seen[edge]){
+                            seen[edge] = 1;
+                            states.push_back(edge);
+                        }
+                    }
+                    for (int state : states)
+                        seen[state] = 0;
+                    if (!states.empty()){
+                        closure(nfa, states, seen);
+                        int next = findState(states);
+                        dfa.transitions[cur*dfa.classCount + cls] = next;
+                    }
+                }
+            }
+            return dfa;
+        }
+
+        // Size of the tables of an automaton, which has to be known before the tables can be declared
+        struct Sizes{
+            int states;
+            int classes;
+        };
+
+        constexpr Sizes measure(const char* const* patterns, int count){
+            Automaton dfa = determinize(patterns, count);
+            return Sizes{(int)dfa.accepts.size(), dfa.classCount};
+        }
+
+        template<int States, int Classes>
+        struct Table{
+            unsigned char classMap[NumOfChars] = {};
+            int transitions[States*Classes] = {};
+            int accepts[States] = {};
+        };
+
+        template<int States, int Classes>
+        constexpr Table<States, Classes> tabulate(const char* const* patterns, int count){
+            Automaton dfa = determinize(patterns, count);
+            Table<States, Classes> table;
+            for (int c=0; c<NumOfChars; c++)
+                table.classMap[c] = dfa.classMap[c];
+            for (int i=0; i<States*Classes; i++)
+                table.transitions[i] = dfa.transitions[i];
+            for (int i=0; i<States; i++)
+                table.accepts[i] = dfa.accepts[i];
+            return table;
+        }
+    }
+
+    // Lexer whose regexps are fixed at compile time. Tokens are numbered by the order of the regexps, and ties go to the
+    // lowest number, same as ::Lexer. lex is a regexp::LexFunction, so a runtime lexer for the parsers can be made with
+    // Lexer(ct::Lexer<...>::lex, newlineToken)
+    template<Pattern... Patterns>
+    class Lexer{
+        static_assert(sizeof...(Patterns) > 0, "ct::Lexer needs at least one regexp");
+        static constexpr const char* patterns[] = {Patterns.str...};
+        static constexpr detail::Sizes sizes = detail::measure(patterns, sizeof...(Patterns));
+        static constexpr detail::Table<sizes.states, sizes.classes> table =
+            detail::tabulate<sizes.states, sizes.classes>(patterns, sizeof...(Patterns));
+
+    public:
+        // Runs the DFA from str, obeying maximal munch. The input ends at end, or at \0 if end is NULL.
+        // Returns the regexp number of the longest match, or -1, and sets matchEnd to the end of the match
+        static constexpr int lex(const char* str, const char* end, const char** matchEnd){
+            int state = 0;
+            int accept = table.accepts[0];
+            const char* acceptEnd = str;
+            for (const char* p = str; p != end; p++){
+                unsigned char c = *p;
+                //\0 and chars outside the alphabet have no transitions
+                if (c == 0 || c >= NumOfChars)
+                    break;
+                state = table.transitions[state*sizes.classes + table.classMap[c]];
+                if (state < 0)
+                    break;
+                if (table.accepts[state] > -1){
+                    accept = table.accepts[state];
+                    acceptEnd = p+1;
+                }
+            }
+            *matchEnd = acceptEnd;
+            return accept;
+        }
+        // Number of DFA states
+        static constexpr int states(){
+            return sizes.states;
+        }
+    };
+
+    // Single regexp fixed at compile time
+    template<Pattern P>
+    class Regexp{
+    public:
+        // Matches the regexp to the beginning of input and returns the # of chars matched, or -1 if nothing was matched
+        static constexpr int match(const char* str, const char* end = NULL){
+            const char* matchEnd = str;
+            if (Lexer<P>::lex(str, end, &matchEnd) < 0)
+                return -1;
+            return matchEnd - str;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,314 @@
+#include "DFA.h"
+#include <algorithm>
+
+//Looks up the DFA state of a closed NFA state set. Unseen sets become new DFA states and are queued for processing
+int regexp::DFA::findState(BaseRegexp &re, std::vector<int>& states, std::map<std::vector<int>, int>& stateNums,
+    std::vector<std::vector<int>>& stateSets){
+    auto found = stateNums.find(states);
+    if (found != stateNums.end())
+        return found->second;
+    int num = newState(re.setAccept(states));
+    stateNums[states] = num;
+    stateSets.push_back(states);
+    return num;
+}
+
+//Subset construction. Each DFA state represents the set of NFA states the simulation could be in at once
+regexp::DFA::DFA(BaseRegexp &re){
+    classCount = re.charClasses(classMap);
+    //Every char of a class behaves the same, so any one of them can stand in for the class
+    std::vector<int> representative(classCount, -1);
+    for (int c=NumOfChars-1; c>=0; c--)
+        representative[classMap[c]] = c;
+
+    std::map<std::vector<int>, int> stateNums;
+    //NFA state sets of each DFA state, indexed by DFA state number
+    std::vector<std::vector<int>> stateSets;
+    //Dedup array for closures, same role as listids in the NFA simulation
+    std::vector<int> listids(re.nfa.size(), -1);
+    int id = 0;
+
+    std::vector<int> states;
+    states.push_back(re.starting);
+    re.closure(states, listids, id++);
+    findState(re, states, stateNums, stateSets);
+
+    //Go thru the DFA states until there is no more, computing the transitions for every char class
+    for (int cur=0; cur<stateSets.size(); cur++){
+        for (int cls=0; cls<classCount; cls++){
+            int c = representative[cls];
+            //The \0 class is never given transitions, even by inverted sets
+            if (c == 0)
+                continue;
+            states.clear();
+            for (int state : stateSets[cur]){
+                int edge = re.nfa.edge[state];
+                if (re.nfa.transitions(state)[c] && listids[edge] != id){
+                    listids[edge] = id;
+                    states.push_back(edge);
+                }
+            }
+            //An empty set is the dead state, which is left as no transition
+            if (!states.empty()){
+                re.closure(states, listids, id);
+                (*this)(cur, cls) = findState(re, states, stateNums, stateSets);
+            }
+            id++;
+        }
+    }
+    minimize();
+}
+
+//Hopcroft's partition refinement. Missing transitions go to an implicit dead state, which is numbered after every real state.
+//Blocks start out split by accept value so that states accepting different regexps stay distinct
+void regexp::DFA::minimize(){
+    int dead = length;
+    int total = length+1;
+    //Transition of a state with the missing ones redirected to the dead state
+    auto target = [&](int state, int cls){
+        if (state == dead)
+            return dead;
+        int next = transitions[state*classCount + cls];
+        return (next < 0) ? dead : next;
+    };
+    //Inverse transitions, indexed by target state * classCount + char class
+    std::vector<std::vector<int>> preds(total*classCount);
+    for (int state=0; state<total; state++){
+        for (int cls=0; cls<classCount; cls++)
+            preds[target(state, cls)*classCount + cls].push_back(state);
+    }
+
+    //Initial partition by accept value. The dead state doesn't accept
+    std::vector<std::vector<int>> blocks;
+    std::vector<int> blockOf(total);
+    std::map<int, int> acceptBlocks;
+    for (int state=0; state<total; state++){
+        int accept = (state == dead) ? -1 : accepts[state];
+        if (acceptBlocks.count(accept) == 0){
+            acceptBlocks[accept] = blocks.size();
+            blocks.push_back(std::vector<int>());
+        }
+        blockOf[state] = acceptBlocks[accept];
+        blocks[blockOf[state]].push_back(state);
+    }
+
+    //Worklist of splitters, which are (block, char class) pairs. inWork tracks which pairs are pending
+    std::vector<std::pair<int, int>> work;
+    std::vector<char> inWork;
+    for (int block=0; block<blocks.size(); block++){
+        for (int cls=0; cls<classCount; cls++){
+            work.push_back(std::make_pair(block, cls));
+            inWork.push_back(1);
+        }
+    }
+    std::vector<char> marked(total, 0);
+    std::vector<int> markCount(total, 0);
+    std::vector<int> predecessors;
+    std::vector<int> touched;
+    while (!work.empty()){
+        int splitter = work.back().first;
+        int cls = work.back().second;
+        work.pop_back();
+        inWork[splitter*classCount + cls] = 0;
+
+        //Mark every state that enters the splitter on the class, counting the marks per block
+        predecessors.clear();
+        for (int state : blocks[splitter]){
+            for (int pred : preds[state*classCount + cls]){
+                if (!marked[pred]){
+                    marked[pred] = 1;
+                    predecessors.push_back(pred);
+                    if (markCount[blockOf[pred]]++ == 0)
+                        touched.push_back(blockOf[pred]);
+                }
+            }
+        }
+        //Split each block that was only partly marked. The marked states move to a new block
+        for (int block : touched){
+            if (markCount[block] < blocks[block].size()){
+                int newBlock = blocks.size();
+                blocks.push_back(std::vector<int>());
+                std::vector<int> kept;
+                for (int state : blocks[block]){
+                    if (marked[state]){
+                        blocks[newBlock].push_back(state);
+                        blockOf[state] = newBlock;
+                    }
+                    else kept.push_back(state);
+                }
+                blocks[block].swap(kept);
+                inWork.resize(blocks.size()*classCount, 0);
+                //Pending splitters have to cover both halves. Otherwise the smaller half is enough
+                for (int c=0; c<classCount; c++){
+                    int half = newBlock;
+                    if (!inWork[block*classCount + c] && blocks[block].size() < blocks[newBlock].size())
+                        half = block;
+                    work.push_back(std::make_pair(half, c));
+                    inWork[half*classCount + c] = 1;
+                }
+            }
+            markCount[block] = 0;
+        }
+        touched.clear();
+        for (int pred : predecessors)
+            marked[pred] = 0;
+    }
+
+    //Number the blocks in BFS order from the starting state, leaving out the dead block
+    int deadBlock = blockOf[dead];
+    std::vector<int> newNum(blocks.size(), -1);
+    std::vector<int> order;
+    newNum[blockOf[0]] = 0;
+    order.push_back(blockOf[0]);
+    for (int i=0; i<order.size(); i++){
+        int rep = blocks[order[i]][0];
+        for (int c=0; c<classCount; c++){
+            int block = blockOf[target(rep, c)];
+            if (block != deadBlock && newNum[block] == -1){
+                newNum[block] = order.size();
+                order.push_back(block);
+            }
+        }
+    }
+    std::vector<int> newTransitions(order.size()*classCount, -1);
+    std::vector<int> newAccepts(order.size(), -1);
+    for (int i=0; i<order.size(); i++){
+        int rep = blocks[order[i]][0];
+        if (rep != dead)
+            newAccepts[i] = accepts[rep];
+        for (int c=0; c<classCount; c++){
+            int block = blockOf[target(rep, c)];
+            if (block != deadBlock)
+                newTransitions[i*classCount + c] = newNum[block];
+        }
+    }
+    transitions.swap(newTransitions);
+    accepts.swap(newAccepts);
+    length = order.size();
+}
+
+size_t regexp::DFA::size(){
+    return length;
+}
+
+int regexp::DFA::classes(){
+    return classCount;
+}
+
+int regexp::DFA::charClass(int c){
+    return classMap[c];
+}
+
+//Adds a row of transitions, all defaulted to -1
+int regexp::DFA::newState(int accept){
+    transitions.resize(transitions.size() + classCount, -1);
+    accepts.push_back(accept);
+    return length++;
+}
+
+int& regexp::DFA::operator()(int state, int cls){
+    return transitions[state*classCount + cls];
+}
+
+int regexp::DFA::accept(int state){
+    return accepts[state];
+}
+
+//Runs the DFA one class lookup and one table lookup per char until it has no transition. Returns the last accept value reached and
+//advances the input pointer to where it was reached
+int regexp::DFA::simulate(char* &str, const char* end, MunchMemo *memo, bool *hitEnd) const{
+    int state = 0;
+    if (hitEnd != NULL)
+        *hitEnd = false;
+    ptrdiff_t lastAcceptPos = 0;
+    int lastAcceptState = accepts[0];
+    if (memo != NULL){
+        memo->trail.clear();
+        if (accepts[0] < 0)
+            memo->trail.push_back(std::make_pair(str, 0));
+    }
+    for (ptrdiff_t i=0; ; i++){
+        //Nothing past a failed pair accepts, so the scan can end here
+        if (memo != NULL && memo->isFailed(str+i, state))
+            break;
+        //The end of a bounded input is treated the same as \0. The scan was still going, so more input could change the token
+        if (str+i == end){
+            if (hitEnd != NULL)
+                *hitEnd = true;
+            break;
+        }
+        unsigned char c = str[i];
+        //Chars outside the alphabet have no transitions. \0 has none either, so the loop ends with the input
+        if (c >= NumOfChars)
+            break;
+        state = transitions[state*classCount + classMap[c]];
+        if (state < 0)
+            break;
+        if (accepts[state] > -1){
+            lastAcceptPos = i+1;
+            lastAcceptState = accepts[state];
+            if (memo != NULL)
+                memo->trail.clear();
+        }
+        else if (memo != NULL){
+            memo->trail.push_back(std::make_pair(str+i+1, state));
+        }
+    }
+    //Every pair reached after the last accept led to no other accept
+    if (memo != NULL){
+        for (auto &pair : memo->trail)
+            memo->setFailed(pair.first, pair.second);
+        memo->tokenEnd = str + lastAcceptPos;
+    }
+    str += lastAcceptPos;
+    return lastAcceptState;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void regexp::MunchMemo::reset(){
+    base = NULL;
+    end = NULL;
+    tokenEnd = NULL;
+    fill = 0;
+    failed.clear();
+    offset = 0;
+}
+
+//Entries before the new token are never looked at again. They are dropped by moving the offset, and only erased
+//once they make up most of the buffer so that dropping stays cheap.
+//A token anywhere else may be in other input at the same addresses, such as a reused buffer, so the entries are dropped
+void regexp::MunchMemo::advance(const char* pos, const char* end, int states, unsigned long long fill){
+    bool follows = base != NULL && end == this->end && states == this->states && fill == this->fill &&
+        (pos == tokenEnd || (tokenEnd == base && pos == tokenEnd+1));
+    if (!follows){
+        reset();
+        base = pos;
+        this->end = end;
+        this->states = states;
+        this->fill = fill;
+        return;
+    }
+    offset += (pos-base) * states;
+    base = pos;
+    if (offset >= failed.size()){
+        failed.clear();
+        offset = 0;
+    }
+    else if (offset > failed.size()/2){
+        failed.erase(failed.begin(), failed.begin() + offset);
+        offset = 0;
+    }
+}
+
+bool regexp::MunchMemo::isFailed(const char* pos, int state) const{
+    size_t index = offset + (pos-base) * states + state;
+    return index < failed.size() && failed[index];
+}
+
+void regexp::MunchMemo::setFailed(const char* pos, int state){
+    size_t index = offset + (pos-base) * states + state;
+    if (index >= failed.size())
+        failed.resize(index + states, 0);
+    failed[index] = 1;
+}
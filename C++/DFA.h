@@ -0,0 +1,51 @@
+#ifndef DFA_H
+#define DFA_H
+
+#include "Regexp.h"
+#include <vector>
+#include <map>
+
+namespace regexp{
+    // Deterministic automaton compiled from the NFA of a BaseRegexp via subset construction, then minimized.
+    // State 0 is the starting state. Chars are grouped into equivalence classes and transition rows are indexed by class
+    class DFA{
+    private:
+        // Transition table indexed by state * classCount + char class. -1 means no transition
+        std::vector<int> transitions;
+        // Accept value of each state, which is what the NFA's isAccepting() returns. -1 means no accept
+        std::vector<int> accepts;
+        // Number of states
+        size_t length = 0;
+        // Maps each char to its equivalence class. Chars in the same class are used by exactly the same NFA transitions
+        unsigned char classMap[NumOfChars];
+        // Number of char classes, which is the width of a transition row
+        int classCount = 0;
+
+        // Returns the DFA state for a closed NFA state set, making a new one if it hasn't been seen yet
+        int findState(BaseRegexp &re, std::vector<int>& states, std::map<std::vector<int>, int>& stateNums,
+            std::vector<std::vector<int>>& stateSets);
+        // Merges equivalent states with Hopcroft's algorithm. States with different accept values are never merged
+        void minimize();
+
+    public:
+        // Builds the DFA from the NFA of a regexp
+        DFA(BaseRegexp &re);
+        size_t size();
+        // Number of char classes
+        int classes();
+        // Returns the class of a char
+        int charClass(int c);
+        // Makes a new state with an accept value and returns its number
+        int newState(int accept);
+        // Return the transition of a state for a given char class
+        int& operator()(int state, int cls);
+        // Return the accept value of a state
+        int accept(int state);
+        // Runs the DFA on a string input, obeying maximal munch. Same contract as BaseRegexp::simulate
+        // Given a memo, stops at pairs known to fail and records the ones that failed this time.
+        // hitEnd is set to whether the scan reached end before running out of transitions
+        int simulate(char* &str, const char* end = NULL, MunchMemo *memo = NULL, bool *hitEnd = NULL) const;
+    };
+}
+
+#endif
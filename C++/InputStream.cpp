@@ -0,0 +1,91 @@
+#include "InputStream.h"
+#include "LineIndex.h"
+#include <cstring>
+#include <atomic>
+
+//Source of fill numbers for every stream
+static std::atomic<unsigned long long> fills(0);
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+//File descriptors are read with the same loop as callbacks
+InputStream::InputStream(int fd, size_t chunkSize) : InputStream(Reader([fd](char* buffer, size_t size){
+#ifdef _WIN32
+        return (long long)_read(fd, buffer, (unsigned int)size);
+#else
+        return (long long)read(fd, buffer, size);
+#endif
+    }), chunkSize){}
+
+//Nothing is read until the first fill(), so the buffer starts out as just the \0
+InputStream::InputStream(Reader reader, size_t chunkSize){
+    this->reader = reader;
+    this->chunkSize = (chunkSize == 0) ? 1 : chunkSize;
+    buffer.push_back(0);
+    fillNumber = ++fills;
+}
+
+char* InputStream::begin(){
+    return buffer.data();
+}
+
+char* InputStream::end(){
+    return buffer.data() + length;
+}
+
+bool InputStream::atEOF() const{
+    return eof;
+}
+
+//The kept input is moved to the front of the buffer and the chunk is read in after it. The buffer only grows when a
+//token doesn't fit in what it already holds
+char* InputStream::fill(char* keep){
+    const char *start = NULL;
+    droppedLines += LineIndex::countNewlines(buffer.data(), keep, start);
+    if (start != NULL)
+        lineStart = offset(start);
+    size_t kept = buffer.data() + length - keep;
+    consumed += keep - buffer.data();
+    memmove(buffer.data(), keep, kept);
+    length = kept;
+    if (buffer.size() < length + chunkSize + 1)
+        buffer.resize(length + chunkSize + 1);
+    size_t wanted = length + chunkSize;
+    while (!eof && length < wanted){
+        long long got = reader(buffer.data() + length, wanted - length);
+        if (got <= 0)
+            eof = true;
+        else length += got;
+    }
+    buffer[length] = 0;
+    fillNumber = ++fills;
+    return buffer.data();
+}
+
+unsigned long long InputStream::fillId() const{
+    return fillNumber;
+}
+
+long long InputStream::offset(const char* pos) const{
+    return consumed + (pos - buffer.data());
+}
+
+long long InputStream::line(const char* pos) const{
+    const char *start = NULL;
+    return droppedLines + LineIndex::countNewlines(buffer.data(), pos, start) + 1;
+}
+
+long long InputStream::column(const char* pos) const{
+    const char *start = NULL;
+    LineIndex::countNewlines(buffer.data(), pos, start);
+    if (start == NULL)
+        return offset(pos) - lineStart;
+    return pos - start;
+}
+
+size_t InputStream::chunk() const{
+    return chunkSize;
+}
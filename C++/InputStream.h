@@ -0,0 +1,60 @@
+#ifndef INPUTSTREAM_H
+#define INPUTSTREAM_H
+
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+// Input read a chunk at a time from a file descriptor or a callback, so that the lexer and parsers can work on inputs
+// too large to hold in memory. The buffer holds what has been read but not yet consumed, followed by a \0.
+// Filling it drops everything before the position still in use, so memory is bounded by the chunk size plus the longest token
+class InputStream{
+public:
+    //Reads up to size bytes into a buffer. Returns the # of bytes read, 0 at end of input, or less than 0 on error
+    typedef std::function<long long(char* buffer, size_t size)> Reader;
+
+private:
+    Reader reader;
+    std::vector<char> buffer;
+    //# of bytes of the buffer holding input, not counting the \0
+    size_t length = 0;
+    size_t chunkSize;
+    //Offset in the input of the first byte of the buffer
+    long long consumed = 0;
+    bool eof = false;
+    //Identifies what the buffer holds. Taken from a counter shared by all streams, so no two fills have the same one
+    unsigned long long fillNumber;
+    //Newlines in the input dropped from the buffer, and the offset in the input of the line the buffer starts on
+    long long droppedLines = 0;
+    long long lineStart = 0;
+
+public:
+    //Reads from a file descriptor, which is left open
+    InputStream(int fd, size_t chunkSize = 1 << 16);
+    //Reads from a callback
+    InputStream(Reader reader, size_t chunkSize = 1 << 16);
+    //Disable copying, since positions handed out point into the buffer
+    InputStream(InputStream&) = delete;
+    InputStream& operator=(InputStream&) = delete;
+
+    //Start and end of the input read so far. Only valid until the next fill()
+    char* begin();
+    char* end();
+    //Whether the whole input has been read, so end() is the end of input
+    bool atEOF() const;
+    //Drops the input before keep and reads the next chunk after what is left. Returns where keep was moved to.
+    //Reads until a whole chunk is in or the input ends. Errors are treated as the end of input
+    char* fill(char* keep);
+    //Changes every time the buffer is filled, and differs between streams. Positions are only comparable while it stays
+    //the same
+    unsigned long long fillId() const;
+    //Offset in the whole input of a position in the buffer
+    long long offset(const char* pos) const;
+    //Line of a position in the buffer, counting from 1, and the # of chars on its line before it. Newlines are counted
+    //as input is dropped, and in the buffer only when asked
+    long long line(const char* pos) const;
+    long long column(const char* pos) const;
+    size_t chunk() const;
+};
+
+#endif
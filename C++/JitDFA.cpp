@@ -0,0 +1,116 @@
+#include "JitDFA.h"
+#include "DFA.h"
+#include <cstring>
+#if defined(__x86_64__) && defined(__linux__)
+#include <sys/mman.h>
+#define JIT_X64
+#endif
+
+void regexp::JitDFA::emit(std::vector<uint8_t>& buffer, std::initializer_list<uint8_t> bytes){
+    buffer.insert(buffer.end(), bytes);
+}
+
+void regexp::JitDFA::emit32(std::vector<uint8_t>& buffer, int32_t value){
+    for (int i=0; i<4; i++)
+        buffer.push_back((uint32_t)value >> (i*8));
+}
+
+//Target -1 is the exit code after the last block
+void regexp::JitDFA::emitJump(std::vector<uint8_t>& buffer, std::initializer_list<uint8_t> opcode, int target,
+    std::vector<std::pair<size_t, int>>& patches){
+    emit(buffer, opcode);
+    patches.push_back(std::make_pair(buffer.size(), target));
+    emit32(buffer, 0);
+}
+
+//The generated function takes the input in rdi, the end of input in rsi and the match end pointer in rdx.
+//eax holds the last accept value and r8 where it was reached. Each state block is, in order:
+//  mov eax, accept; mov r8, rdi        only if the state accepts
+//  cmp rdi, rsi; je exit               the end of a bounded input
+//  movzx ecx, byte [rdi]; inc rdi
+//  lea edx, [rcx-low]; cmp edx, high-low; jbe state    for each run of chars going to the same state, or
+//  cmp ecx, c; je state                                for a run of one char
+//  jmp exit
+//The exit stores r8 thru the match end pointer, which is moved to r9 at the start. \0 and chars outside the alphabet
+//have no transitions, so they always exit
+regexp::JitDFA::JitDFA(DFA &dfa){
+#ifdef JIT_X64
+    std::vector<uint8_t> buffer;
+    std::vector<size_t> blocks(dfa.size());
+    std::vector<std::pair<size_t, int>> patches;
+
+    emit(buffer, {0x49, 0x89, 0xD1});                       //mov r9, rdx
+    emit(buffer, {0xB8}); emit32(buffer, -1);               //mov eax, -1
+    emit(buffer, {0x49, 0x89, 0xF8});                       //mov r8, rdi
+    for (int state=0; state<dfa.size(); state++){
+        blocks[state] = buffer.size();
+        if (dfa.accept(state) > -1){
+            emit(buffer, {0xB8}); emit32(buffer, dfa.accept(state));
+            emit(buffer, {0x49, 0x89, 0xF8});
+        }
+        emit(buffer, {0x48, 0x39, 0xF7});                   //cmp rdi, rsi
+        emitJump(buffer, {0x0F, 0x84}, -1, patches);        //je exit
+        emit(buffer, {0x0F, 0xB6, 0x0F});                   //movzx ecx, byte [rdi]
+        emit(buffer, {0x48, 0xFF, 0xC7});                   //inc rdi
+        for (int low=1; low<NumOfChars; ){
+            int target = dfa(state, dfa.charClass(low));
+            int high = low;
+            while (high+1 < NumOfChars && dfa(state, dfa.charClass(high+1)) == target)
+                high++;
+            if (target >= 0){
+                if (low == high){
+                    emit(buffer, {0x83, 0xF9, (uint8_t)low});                        //cmp ecx, low
+                    emitJump(buffer, {0x0F, 0x84}, target, patches);                 //je state
+                }
+                else{
+                    emit(buffer, {0x8D, 0x51, (uint8_t)(-low)});                     //lea edx, [rcx-low]
+                    emit(buffer, {0x83, 0xFA, (uint8_t)(high-low)});                 //cmp edx, high-low
+                    emitJump(buffer, {0x0F, 0x86}, target, patches);                 //jbe state
+                }
+            }
+            low = high+1;
+        }
+        emitJump(buffer, {0xE9}, -1, patches);              //jmp exit
+    }
+    size_t exit = buffer.size();
+    emit(buffer, {0x4D, 0x89, 0x01});                       //mov [r9], r8
+    emit(buffer, {0xC3});                                   //ret
+
+    for (auto &patch : patches){
+        size_t target = (patch.second < 0) ? exit : blocks[patch.second];
+        int32_t offset = (int32_t)(target - (patch.first + 4));
+        memcpy(&buffer[patch.first], &offset, 4);
+    }
+
+    //Written while writable, then made executable and read-only
+    void *region = mmap(NULL, buffer.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED)
+        return;
+    memcpy(region, buffer.data(), buffer.size());
+    if (mprotect(region, buffer.size(), PROT_READ | PROT_EXEC) != 0){
+        munmap(region, buffer.size());
+        return;
+    }
+    code = region;
+    codeSize = buffer.size();
+    function = (LexFunction)region;
+#endif
+}
+
+regexp::JitDFA::~JitDFA(){
+#ifdef JIT_X64
+    if (code != NULL)
+        munmap(code, codeSize);
+#endif
+}
+
+bool regexp::JitDFA::ok() const{
+    return function != NULL;
+}
+
+int regexp::JitDFA::simulate(char* &str, const char* end) const{
+    const char* matchEnd;
+    int accept = function(str, end, &matchEnd);
+    str = (char*)matchEnd;
+    return accept;
+}
@@ -0,0 +1,42 @@
+#ifndef JITDFA_H
+#define JITDFA_H
+
+#include "Regexp.h"
+#include <vector>
+#include <cstdint>
+#include <initializer_list>
+
+namespace regexp{
+    class DFA;
+
+    // Minimized DFA compiled to x86-64 machine code. Each state is a block of compare-and-jump code that records the
+    // state's accept value and branches on the next char to the block of the next state.
+    // Only supported on x86-64 Linux. Elsewhere, or if the code can't be mapped, ok() is false and the table DFA is used
+    class JitDFA{
+    private:
+        // Executable region holding the code, and its size
+        void *code = NULL;
+        size_t codeSize = 0;
+        LexFunction function = NULL;
+
+        // Helpers for emitting code into a buffer
+        void emit(std::vector<uint8_t>& buffer, std::initializer_list<uint8_t> bytes);
+        void emit32(std::vector<uint8_t>& buffer, int32_t value);
+        // Emits a rel32 jump whose target block is filled in once every block has been placed
+        void emitJump(std::vector<uint8_t>& buffer, std::initializer_list<uint8_t> opcode, int target,
+            std::vector<std::pair<size_t, int>>& patches);
+
+    public:
+        // Compiles the DFA. The DFA isn't needed afterwards
+        JitDFA(DFA &dfa);
+        ~JitDFA();
+        bool ok() const;
+        // Runs the compiled DFA on a string input, obeying maximal munch. Same contract as BaseRegexp::simulate
+        int simulate(char* &str, const char* end = NULL) const;
+        //Disable copying and reassigning
+        JitDFA(JitDFA&) = delete;
+        JitDFA& operator=(JitDFA&) = delete;
+    };
+}
+
+#endif
@@ -0,0 +1,91 @@
+#include "KeywordTable.h"
+#include <algorithm>
+#include <cstring>
+
+//64-bit FNV-1a of the lexeme. The lexeme is only read once, and buckets and slots are both worked out from this hash
+unsigned long long regexp::KeywordTable::hash(const char *str, size_t length){
+    unsigned long long h = 14695981039346656037ull;
+    for (size_t i=0; i<length; i++){
+        h ^= (unsigned char)str[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+//Mixes the hash with a bucket's seed so that each seed sends the keys to different slots
+size_t regexp::KeywordTable::slot(unsigned long long h, unsigned seed) const{
+    h ^= seed * 0x9E3779B97F4A7C15ull;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    return h & (slots.size()-1);
+}
+
+void regexp::KeywordTable::add(const std::string &keyword, int token, int host){
+    keys.push_back(keyword);
+    tokens.push_back(token);
+    hosts.push_back(host);
+    if (host >= isHost.size())
+        isHost.resize(host+1, 0);
+    isHost[host] = 1;
+    minLength = std::min(minLength, keyword.size());
+    maxLength = std::max(maxLength, keyword.size());
+}
+
+//Hash and displace. Buckets are placed largest first, each trying seeds until all of its keys land in empty slots.
+//Slots are twice the # of keys, which keeps the seed search short. Distinct keywords can't collide on every seed
+//unless their 64-bit hashes are equal
+void regexp::KeywordTable::build(){
+    size_t slotCount = 1;
+    while (slotCount < 2*keys.size())
+        slotCount *= 2;
+    size_t bucketCount = 1;
+    while (bucketCount < keys.size())
+        bucketCount *= 2;
+    std::vector<std::vector<int>> buckets(bucketCount);
+    for (int k=0; k<keys.size(); k++)
+        buckets[(hash(keys[k].data(), keys[k].size()) >> 40) & (bucketCount-1)].push_back(k);
+    std::vector<int> order(bucketCount);
+    for (int b=0; b<bucketCount; b++)
+        order[b] = b;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b){
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    seeds.assign(bucketCount, 0);
+    slots.assign(slotCount, -1);
+    std::vector<size_t> placed;
+    for (int b : order){
+        if (buckets[b].empty())
+            break;
+        for (unsigned seed=1; ; seed++){
+            placed.clear();
+            for (int k : buckets[b]){
+                size_t to = slot(hash(keys[k].data(), keys[k].size()), seed);
+                if (slots[to] != -1 || std::find(placed.begin(), placed.end(), to) != placed.end())
+                    break;
+                placed.push_back(to);
+            }
+            if (placed.size() == buckets[b].size()){
+                seeds[b] = seed;
+                for (int i=0; i<placed.size(); i++)
+                    slots[placed[i]] = buckets[b][i];
+                break;
+            }
+        }
+    }
+}
+
+int regexp::KeywordTable::find(const char *str, size_t length, int host) const{
+    if (host >= isHost.size() || !isHost[host] || length < minLength || length > maxLength)
+        return host;
+    unsigned long long h = hash(str, length);
+    int k = slots[slot(h, seeds[(h >> 40) & (seeds.size()-1)])];
+    if (k < 0 || hosts[k] != host || keys[k].size() != length || memcmp(keys[k].data(), str, length) != 0)
+        return host;
+    return tokens[k];
+}
+
+size_t regexp::KeywordTable::size() const{
+    return keys.size();
+}
@@ -0,0 +1,42 @@
+#ifndef KEYWORDTABLE_H
+#define KEYWORDTABLE_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace regexp{
+    // Perfect hash table of the keywords a Lexer folds into its identifier regexps. The lexer matches a keyword as an
+    // identifier, then looks the identifier up here to turn it back into the keyword's token.
+    // Keys are hashed into buckets, and each bucket is given a seed that sends all of its keys to empty slots,
+    // so a lookup is one hash and one compare however many keywords there are
+    class KeywordTable{
+    private:
+        // Keyword lexemes, the regexp number of each, and the regexp number of the identifier it was folded into
+        std::vector<std::string> keys;
+        std::vector<int> tokens;
+        std::vector<int> hosts;
+        // Seed of each bucket, and the key in each slot. -1 means an empty slot
+        std::vector<unsigned> seeds;
+        std::vector<int> slots;
+        // Whether each regexp number has keywords folded into it
+        std::vector<char> isHost;
+        // Shortest and longest keyword, so most identifiers are turned away without hashing
+        size_t minLength = (size_t)-1;
+        size_t maxLength = 0;
+
+        static unsigned long long hash(const char *str, size_t length);
+        size_t slot(unsigned long long h, unsigned seed) const;
+
+    public:
+        // Adds a keyword, given its regexp number and the regexp number of the identifier that matches it
+        void add(const std::string &keyword, int token, int host);
+        // Builds the hash once every keyword has been added
+        void build();
+        // Returns the keyword token of a lexeme matched by the host regexp, or the host itself if the lexeme isn't a keyword
+        int find(const char *str, size_t length, int host) const;
+        size_t size() const;
+    };
+}
+
+#endif
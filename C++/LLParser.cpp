@@ -52,6 +52,7 @@ LLParser::LLParser(char* grammarConfig, Lexer *lexptr) : BaseParserGenerator(gra
     for (int i=0; i<toRuleCount(ruleNum); i++){
         populateTable(i, std::unordered_set<int>());
     }
+    table.compress();
 }
 
 LLParser::~LLParser(){
@@ -71,13 +72,33 @@ void LLParser::deleteValues(int count){
 
 //Reset all parse variables and shift until next reduction 
 ParseStatus LLParser::parse(char* input){
-    curpos = input;
-    prevpos = input;
+    setInput(input);
+    return start();
+}
+ParseStatus LLParser::parse(const TokenStream &tokens){
+    setInput(tokens);
+    return start();
+}
+ParseStatus LLParser::parse(InputStream &input){
+    setInput(input);
+    return start();
+}
+ParseStatus LLParser::parse(const char *begin, const char *end){
+    setInput(begin, end);
+    return start();
+}
+ParseStatus LLParser::parse(std::string_view input){
+    //An empty view may have no data, and a NULL end would mean \0-terminated input
+    if (input.empty())
+        input = std::string_view("", 0);
+    return parse(input.data(), input.data() + input.size());
+}
+
+ParseStatus LLParser::start(){
     deleteValues(valueStack.size());
     symbolStack.clear();
     //Initialize the symbolStack with starting symbol
     symbolStack.push_back(toRuleNum(0));
-    lexptr->reset();
     curTokenNum = next();
     expectedSymbol = 0;
     return shiftHelper();
@@ -136,7 +157,7 @@ std::vector<int> LLParser::expectedTokens(){
     //If the symbol is nonterminal, then the expected tokens are all that qualify as lookahead for that symbol
     //Search the parse table for the tokens
     for (int i=0; i<tokenNum; i++){
-        if (table(toRuleCount(expectedSymbol), i) >= 0){
+        if (table.at(toRuleCount(expectedSymbol), i) >= 0){
             expected.push_back(i);
         }
     }
@@ -174,7 +195,7 @@ ParseStatus LLParser::shiftHelper(){
         }
         //If symbol is nonterminal, insert the reduction symbol and the correct production backwards into the parse stack based on parse table
         else{
-            int productionPos = table(toRuleCount(symbol), curTokenNum);
+            int productionPos = table.at(toRuleCount(symbol), curTokenNum);
             //If table entry doesn't exist for current lhs and token, then see if the lhs derives epsilon
             if (productionPos < 0){
                 if (derivesEpsilon[toRuleCount(symbol)] > -1){
@@ -35,6 +35,8 @@ private:
     void addTokenValue();
     //Deletes x number of ParserValues on the value stack. Responsible for cleaning the associated memory
     void deleteValues(int count);
+    //Resets the parse stacks and shifts up to the first reduction. Input has to be set beforehand
+    ParseStatus start();
 
 public:
     friend std::ostream& operator<<(std::ostream& os, LLParser& parser);
@@ -43,6 +45,10 @@ public:
     //Reset all internal variables and initiate parse on a new input. Begin the first reduction
     //Will throw when called after parse fails
     ParseStatus parse(char *input);
+    ParseStatus parse(const TokenStream &tokens);
+    ParseStatus parse(InputStream &input);
+    ParseStatus parse(const char *begin, const char *end);
+    ParseStatus parse(std::string_view input);
     //Finish a pending reduction and associate the produced lhs symbol with the reduced value. Begin the next reduction
     //Primary means of advancing the parsing
     //Will throw when called after parse fails
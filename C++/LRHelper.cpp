@@ -1,4 +1,5 @@
 #include "LRHelper.h"
+#include <algorithm>
 
 LRItem LRItem::advance() const{
     LRItem item;
@@ -13,27 +14,47 @@ bool operator==(const LRItem &x, const LRItem &y){
     return (y.prodPos==x.prodPos && y.dotPos==x.dotPos && y.lhs==x.lhs && x.isStarting == y.isStarting);
 }
 
-void LRStateSet::newState(){
-    length++;
-    kernelSet.push_back(std::unordered_set<LRItem>());
-    closureSet.push_back(std::vector<LRItem>());
+uint64_t LRStateSet::prepare(std::vector<uint32_t> &kernel){
+    std::sort(kernel.begin(), kernel.end());
+    kernel.erase(std::unique(kernel.begin(), kernel.end()), kernel.end());
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (uint32_t item : kernel){
+        h = (h ^ item) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 29;
+    }
+    return h;
 }
 
-void LRStateSet::pop(){
-    kernelSet.pop_back();
-    closureSet.pop_back();
-    length--;
+size_t LRStateSet::size(){
+    return kernelStart.size() - 1;
 }
 
-size_t LRStateSet::size(){
-    return length;
+int LRStateSet::add(std::vector<uint32_t> &kernel){
+    uint64_t h = prepare(kernel);
+    return add(kernel.data(), kernel.data() + kernel.size(), h);
+}
+
+int LRStateSet::add(const uint32_t *begin, const uint32_t *end, uint64_t hash){
+    //Check the states with the same hash for a repeat of the kernel
+    auto range = states.equal_range(hash);
+    for (auto i=range.first; i!=range.second; i++){
+        int state = i->second;
+        if (kernelEnd(state) - kernelBegin(state) == end - begin && std::equal(begin, end, kernelBegin(state)))
+            return state;
+    }
+    //Otherwise, add a new state
+    int state = size();
+    kernels.insert(kernels.end(), begin, end);
+    kernelStart.push_back(kernels.size());
+    states.emplace(hash, state);
+    return state;
 }
 
-std::unordered_set<LRItem>& LRStateSet::kernelState(int index){
-    return kernelSet[index];
+const uint32_t* LRStateSet::kernelBegin(int index){
+    return kernels.data() + kernelStart[index];
 }
-std::vector<LRItem>& LRStateSet::closureState(int index){
-    return closureSet[index];
+const uint32_t* LRStateSet::kernelEnd(int index){
+    return kernels.data() + kernelStart[index+1];
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -42,57 +63,146 @@ size_t LRTable::size(){
     return length;
 }
 
-LRTable::LRTable(int symbols){
-    symbolCount = symbols;
+//Every symbol starts out in column 0, which never gets an action
+LRTable::LRTable(int tokens, int symbols){
+    tokenCount = tokens;
+    columns.assign(symbols, 0);
 }
 
-LRTable::~LRTable(){
-    for (int* row : transitions)
-        delete[] row;
-    for (int* reduction : reductions)
-        delete[] reduction;
+//Terminals have to be added before nonterminals
+void LRTable::addSymbol(int symbolNum){
+    if (columns[symbolNum] == 0){
+        columns[symbolNum] = width++;
+        if (symbolNum < tokenCount)
+            terminalWidth = width;
+    }
 }
 
-//Add new row in parse table
+//Add new row in parse table, with all values set to -1 as default
 void LRTable::newRow(){
     length++;
-    //Initiate new parse table entry
-    transitions.push_back(new int[symbolCount]);
-    reductions.push_back(new int[3]);
-    //Set all values in new entry to -1 as default
-    for (int i=0; i<symbolCount; i++){
-        transitions.back()[i] = -1;
+    buildCells.resize(length*width, -1);
+}
+
+//Finds the default of each row, then packs the rows leaving the defaults out
+void LRTable::compress(){
+    expectedWords = (terminalWidth + 63) / 64;
+    expected.assign(length*expectedWords, 0);
+    for (int state=0; state<length; state++){
+        for (int c=0; c<terminalWidth; c++){
+            if (buildCells[state*width + c] != -1)
+                expected[state*expectedWords + c/64] |= (uint64_t)1 << (c%64);
+        }
     }
-    reductions.back()[0] = -1;
-    reductions.back()[1] = -1;
-    reductions.back()[2] = -1;
-}
-
-//Make last state reduction state
-void LRTable::reduceState(int prodPos, int lhs, int prodNum, bool isAccepting){
-    //The number that the row will be set to is -3 for accepting state and -2 otherwise
-    int entryNum = (isAccepting) ? -3 : -2;
-    //Set entire table row to -2 (signifies a reduction) for symbols that have not yet been shifted. This prioritizes shift over reduce
-    for (int i=0; i<symbolCount; i++){
-        if (transitions.back()[i] == -1)
-            transitions.back()[i] = entryNum;
+    std::vector<int> counts(prodPositions.size(), 0);
+    std::vector<int> defaults(length, -1);
+    for (int state=0; state<length; state++){
+        int *row = buildCells.data() + state*width;
+        int most = 0;
+        for (int c=0; c<terminalWidth; c++){
+            if (row[c] < -1 && !isAccept(row[c]) && ++counts[reducedProd(row[c])] > most){
+                most = counts[reducedProd(row[c])];
+                defaults[state] = row[c];
+            }
+        }
+        for (int c=0; c<terminalWidth; c++){
+            if (row[c] < -1)
+                counts[reducedProd(row[c])] = 0;
+        }
     }
-    //Set reduction parameters
-    reductions.back()[0] = prodPos;
-    reductions.back()[1] = lhs;
-    reductions.back()[2] = prodNum;
+    actions.pack(length, terminalWidth, [&](int state, int c){
+        int cell = buildCells[state*width + c];
+        return (cell == -1) ? defaults[state] : cell;
+    }, defaults);
+
+    std::vector<int> gotoCounts(length, 0);
+    std::vector<int> gotoDefaults(width - terminalWidth, -1);
+    for (int n=0; n<width-terminalWidth; n++){
+        int most = 0;
+        for (int state=0; state<length; state++){
+            int target = buildCells[state*width + terminalWidth + n];
+            if (target >= 0 && ++gotoCounts[target] > most){
+                most = gotoCounts[target];
+                gotoDefaults[n] = target;
+            }
+        }
+        for (int state=0; state<length; state++){
+            int target = buildCells[state*width + terminalWidth + n];
+            if (target >= 0)
+                gotoCounts[target] = 0;
+        }
+    }
+    gotos.pack(width - terminalWidth, length, [&](int n, int state){
+        int target = buildCells[state*width + terminalWidth + n];
+        return (target == -1) ? gotoDefaults[n] : target;
+    }, gotoDefaults);
+    buildCells = std::vector<int32_t>();
+}
+
+int LRTable::addProduction(int prodPos, int lhs, int prodNum, int length){
+    prodPositions.push_back(prodPos);
+    lhsNums.push_back(lhs);
+    prodNums.push_back(prodNum);
+    lengths.push_back(length);
+    lhsRows.push_back(columns[lhs] - terminalWidth);
+    return prodPositions.size() - 1;
+}
+
+void LRTable::shift(int state, int symbolNum, int target){
+    buildCells[state*width + columns[symbolNum]] = target;
+}
+
+//Place a reduction in a cell, resolving conflicts the way yacc does
+void LRTable::reduce(int state, int symbolNum, int prod, bool isAccepting){
+    int &cell = buildCells[state*width + columns[symbolNum]];
+    int action = reduction(prod, isAccepting);
+    //Shifts take priority over reductions. Unused symbols never get an action
+    if (cell >= 0 || columns[symbolNum] == 0)
+        return;
+    if (cell == -1 || reducedProd(action) < reducedProd(cell) || (reducedProd(action) == reducedProd(cell) && isAccepting))
+        cell = action;
+}
+
+int LRTable::reduction(int prod, bool isAccepting){
+    return (isAccepting) ? -3-2*prod : -2-2*prod;
+}
+int LRTable::reducedProd(int action){
+    return (-2-action)/2;
+}
+bool LRTable::isAccept(int action){
+    return action < -1 && (-action)%2 == 1;
 }
 
 //Reduction parameter accessors with expressive syntax
-int& LRTable::prodPos(int state){
-    return reductions[state][0];
+int LRTable::prodPos(int prod){
+    return prodPositions[prod];
 }
-int& LRTable::lhsNum(int state){
-    return reductions[state][1];
+int LRTable::lhsNum(int prod){
+    return lhsNums[prod];
 }
-int& LRTable::prodNum(int state){
-    return reductions[state][2];
+int LRTable::prodNum(int prod){
+    return prodNums[prod];
 }
-int& LRTable::operator()(int state, int symbolNum){
-    return transitions[state][symbolNum];
+int LRTable::prodLength(int prod){
+    return lengths[prod];
+}
+
+int LRTable::column(int symbolNum){
+    return columns[symbolNum];
+}
+int LRTable::operator()(int state, int symbolNum){
+    int c = columns[symbolNum];
+    if (!buildCells.empty())
+        return buildCells[state*width + c];
+    if (c < terminalWidth)
+        return actions(state, c);
+    return gotos(c - terminalWidth, state);
+}
+
+bool LRTable::expects(int state, int column){
+    return expected[state*expectedWords + column/64] >> (column%64) & 1;
+}
+
+size_t LRTable::bytes(){
+    return actions.bytes() + gotos.bytes() + expected.size()*sizeof(uint64_t);
 }
\ No newline at end of file
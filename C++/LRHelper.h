@@ -1,7 +1,9 @@
 #pragma once
 #include <vector>
-#include <unordered_set>
+#include <unordered_map>
 #include <functional>
+#include <cstdint>
+#include "CombTable.h"
 
 //Data structure representing a LR item 
 struct LRItem{
@@ -27,62 +29,131 @@ namespace std {
         public :
             size_t operator()(const LRItem &item ) const
             {
-                return item.dotPos ^ item.lhs;
+                //The lhs follows from the production, so it is left out
+                uint64_t h = ((uint64_t)item.prodPos << 33) ^ ((uint64_t)item.dotPos << 1) ^ item.isStarting;
+                h *= 0x9E3779B97F4A7C15ULL;
+                return h ^ (h >> 32);
             }
     };
 };
 
-//Data structure representing the entire set of item states. Maintains two vectors of same size to separate kernel and closure sets
+//Data structure representing the entire set of item states. Only the kernel of each state is kept, packed into 32-bit items
+//(see LRParser::packItem) sorted and stored end to end. Kernels are interned in a hash map so each repeat is found in one lookup
 class LRStateSet{
 private:
-    //The kernel states of the set. Used set to make checking for repeat kernel states easier
-    std::vector<std::unordered_set<LRItem>> kernelSet;
-    //The closure states of the set.
-    std::vector<std::vector<LRItem>> closureSet;
-    //Length of 2 vectors
-    size_t length = 0;
+    //The packed kernels of all states, and where each state's kernel starts. Padded at the end to allow looping
+    std::vector<uint32_t> kernels;
+    std::vector<size_t> kernelStart{0};
+    //Maps the hash of a kernel to the states with that hash
+    std::unordered_multimap<uint64_t, int> states;
 public:
-    //Make new state 
-    void newState();
     //Return size
     size_t size();
-    //Pop off the last state
-    void pop();
-    //Returns a specified kernel/closure state in the state set
-    std::unordered_set<LRItem>& kernelState(int index);
-    std::vector<LRItem>& closureState(int index);
+    //Sorts a kernel and removes repeated items, returning its hash. Doesn't touch the set, so it can run on any thread
+    static uint64_t prepare(std::vector<uint32_t> &kernel);
+    //Returns the state with the given kernel, making a new one if it doesn't exist yet. The kernel is sorted in place
+    int add(std::vector<uint32_t> &kernel);
+    //Same as above for a kernel that has already been prepared
+    int add(const uint32_t *begin, const uint32_t *end, uint64_t hash);
+    //Returns the start and end of the kernel of a state
+    const uint32_t* kernelBegin(int index);
+    const uint32_t* kernelEnd(int index);
+};
+
+//The states shifted to from one state. Each symbol shifted, with the prepared kernel of the state it goes to
+struct LRShifts{
+    std::vector<int> symbols;
+    std::vector<uint64_t> hashes;
+    //Kernels stored end to end. Padded at the end to allow looping
+    std::vector<uint32_t> kernels;
+    std::vector<size_t> kernelStart;
+};
+
+//Scratch space for finding the shifts of a state. Each thread building the table has its own
+struct LRWorkspace{
+    //Items of the state being processed
+    std::vector<LRItem> items;
+    //Whether a specific symbol has been subject to closure
+    std::vector<char> closed;
+    //Kernels of the states shifted to for each symbol, and the symbols in the order they were first shifted
+    std::vector<std::vector<uint32_t>> shifted;
+    std::vector<int> symbols;
 };
 
-//Represents LR parse table
+//Represents LR parse table. While the table is built, rows are stored one after another in a single array. Terminals the
+//grammar never uses share one column that has no actions, so each row is only as wide as the symbols the grammar uses plus 1.
+//Once built, the table is compressed into an action table of states by terminal columns and a goto table of nonterminals
+//by states, both packed by row displacement unless a dense table would be smaller. A state's most common reduction becomes
+//the default action of its row, in place of its errors as well, so an error may only be found after some reductions but
+//always before the next shift. A nonterminal's most common goto becomes the default of its row
 class LRTable {
-    //Vector of int arrays to represent the transition table of states to symbols
-    //-1 is no transition, -2 is reduction, -3 is accept, +ve indicates which state to shift to
-    std::vector<int*> transitions;
-    //Represent the reduction attributes of each state, if any. 
-    //[0] is production position, [1] is the lhs, [2] is the production number 
-    std::vector<int*> reductions;
+    //-1 is no transition, +ve indicates which state to shift to. Reductions are -2-2*(production #) and accepts are
+    //-3-2*(production #), so each cell names the production it reduces
+    std::vector<int32_t> buildCells;
+    CombTable actions;
+    CombTable gotos;
+    //Bitset of the terminal columns with an action in each state before compression, which the defaults hide
+    std::vector<uint64_t> expected;
+    int expectedWords = 0;
+    //Maps symbols to columns. Terminal columns come before nonterminal ones
+    std::vector<int> columns;
+    //# of columns, and # of them for terminals
+    int width = 1;
+    int terminalWidth = 1;
+    int tokenCount;
+    //Reduction attributes of each production in grammar order. Position in the grammar, lhs, production number,
+    //# of rhs symbols, and row of the lhs in the goto table
+    std::vector<int> prodPositions;
+    std::vector<int> lhsNums;
+    std::vector<int> prodNums;
+    std::vector<int> lengths;
+    std::vector<int> lhsRows;
     //Length of table
     size_t length = 0;
-    //# of symbols in the grammar
-    int symbolCount;
 public:
     size_t size();
-    //Initializes symbol Count
-    LRTable(int symbols);
-    ~LRTable();
+    //Initializes the column map for the given # of tokens and symbols
+    LRTable(int tokens, int symbols);
     //Delete copy and assignment constructors
     LRTable(LRTable&) = delete;
     LRTable &operator=(LRTable&) = delete;
+    //Give a symbol its own column. All symbols have to be added before the first row
+    void addSymbol(int symbolNum);
     //Add new row to table
     void newRow();
-    //Turn the last state into a reduction state. Prioritize shift over reduce, so shift actions won't be overwritten
-    void reduceState(int prodPos, int lhs, int prodNum, bool isAccepting);
-    //Returns production position in reducing state
-    int& prodPos(int state);
-    //Return reduction lhs num reference for a state
-    int& lhsNum(int state);
-    //Return reduction production num reference for state
-    int& prodNum(int state);
-    //Return the transition of a state for a given symbol
-    int& operator()(int state, int symbolNum);
+    //Compresses the table. Called once it is done, after which shift() and reduce() can't be called
+    void compress();
+    //Record the attributes of the next production in the grammar. Returns its production #
+    int addProduction(int prodPos, int lhs, int prodNum, int length);
+    //Put a shift or goto in a state for a symbol
+    void shift(int state, int symbolNum, int target);
+    //Put a reduction in a state for one lookahead symbol. Shift actions are never overwritten. Between two reductions
+    //the production earlier in the grammar is kept, and accept is kept over a reduction of the same production
+    void reduce(int state, int symbolNum, int prod, bool isAccepting);
+    //Encode and decode reduction actions
+    static int reduction(int prod, bool isAccepting);
+    static int reducedProd(int action);
+    static bool isAccept(int action);
+    //Return reduction attributes of a production
+    int prodPos(int prod);
+    int lhsNum(int prod);
+    int prodNum(int prod);
+    int prodLength(int prod);
+    //Return the column of a symbol
+    int column(int symbolNum);
+    //Action of a compressed table's state for a terminal column, and the state to go to after reducing a production.
+    //Kept in the header so the parse loops can inline them
+    int action(int state, int column){
+        return actions(state, column);
+    }
+    int gotoState(int state, int prod){
+        return gotos(lhsRows[prod], state);
+    }
+    //Return the transition of a state for a given symbol. Once compressed, nonterminals with no transition from a state
+    //give the default goto instead of -1
+    int operator()(int state, int symbolNum);
+    //Whether a state had an action for a terminal column before compression
+    bool expects(int state, int column);
+    //# of bytes used by the compressed table
+    size_t bytes();
 };
\ No newline at end of file
@@ -1,4 +1,13 @@
 #include "LRParser.h"
+#include <climits>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include <thread>
+#include <atomic>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 int LRParser::curSymbol(const LRItem &item){
     //Length of item's production
@@ -11,24 +20,34 @@ int LRParser::curSymbol(const LRItem &item){
     else return grammar[item.prodPos + item.dotPos + 1];
 }
 
-void LRParser::closure(LRStateSet &stateSet, int stateNum){
-    //Array tracking whether a specific symbol has been subject to closure. Closure happens once per symbol
-    bool *closed = new bool[ruleNum];
-    for (int i=0; i<ruleNum; i++){
-        closed[i] = false;
-    }
-    //Loop thru each item in the kernel set
-    for (const LRItem &item : stateSet.kernelState(stateNum)){
-        closureHelper(stateSet, item, closed, stateNum);
+uint32_t LRParser::packItem(const LRItem &item){
+    return (uint32_t)(item.prodPos + item.dotPos) << 1 | item.isStarting;
+}
+
+LRItem LRParser::unpackItem(uint32_t packed){
+    LRItem item;
+    int prod = itemProd[packed >> 1];
+    item.prodPos = table.prodPos(prod);
+    item.dotPos = (packed >> 1) - item.prodPos;
+    item.lhs = table.lhsNum(prod);
+    item.isStarting = packed & 1;
+    return item;
+}
+
+void LRParser::closure(std::vector<LRItem> &items, std::vector<char> &closed){
+    int kernelSize = items.size();
+    //Loop thru each item in the kernel, and then the closure items as they are added
+    for (int i=0; i<items.size(); i++){
+        closureHelper(items, items[i], closed);
     }
-    for (int i=0; i<stateSet.closureState(stateNum).size(); i++){
-        closureHelper(stateSet, stateSet.closureState(stateNum)[i], closed, stateNum);
+    //Every closure item's lhs was closed, so resetting them resets the array
+    for (int i=kernelSize; i<items.size(); i++){
+        closed[items[i].lhs] = false;
     }
-    delete[] closed;
 }
 
 //Gets called on every LRItem in the parse state during closure
-void LRParser::closureHelper(LRStateSet &stateSet, LRItem item, bool *closed, int stateNum){
+void LRParser::closureHelper(std::vector<LRItem> &items, LRItem item, std::vector<char> &closed){
     int symbol = curSymbol(item);
     //If the symbol is nonterminal and hasnt been closed yet
     if (!isTerminal(symbol) && !closed[symbol]){
@@ -36,114 +55,306 @@ void LRParser::closureHelper(LRStateSet &stateSet, LRItem item, bool *closed, in
         //For every production the symbol derives. Add a starting LR item for the production into the closure set
         for (int r=ruleStart(toRuleCount(symbol)); r<ruleStart(toRuleCount(symbol+1)); r=nextProduction(r)){
             LRItem item = {r, 0, symbol, false};
-            stateSet.closureState(stateNum).push_back(item);
+            items.push_back(item);
         }
     }
 }
 
-//Shifts the items in a given state for one symbol. Makes new state if it doesn't exist yet 
-int LRParser::shiftSymbol(LRStateSet &stateSet, int stateNum, int symbol){
-    //Add new state to the set and track its index
-    stateSet.newState();
-    int back = stateSet.size()-1;
-    //For every item in the input state, advance any that have the given symbol as its dot symbol
-    //Add them into the kernel of the new state
-    for (const LRItem &item : stateSet.closureState(stateNum)){
-        if (curSymbol(item) == symbol){
-            stateSet.kernelState(back).insert(item.advance());
-        }
+//Closes a state and advances every item over its dot symbol into the kernel of the state shifted to for that symbol
+void LRParser::shiftState(LRStateSet &stateSet, int state, LRShifts &shifts, LRWorkspace &workspace){
+    std::vector<LRItem> &items = workspace.items;
+    items.clear();
+    for (const uint32_t *i=stateSet.kernelBegin(state); i<stateSet.kernelEnd(state); i++){
+        items.push_back(unpackItem(*i));
     }
-    for (const LRItem &item : stateSet.kernelState(stateNum)){
-        if (curSymbol(item) == symbol){
-            stateSet.kernelState(back).insert(item.advance());
-        }
+    closure(items, workspace.closed);
+    for (const LRItem &item : items){
+        int symbol = curSymbol(item);
+        if (symbol == -1)
+            continue;
+        if (workspace.shifted[symbol].empty())
+            workspace.symbols.push_back(symbol);
+        workspace.shifted[symbol].push_back(packItem(item.advance()));
     }
-
-    //Check if the newest kernel state is a repeat of any old kernel state
-    for (int i=0; i<back; i++){
-        if (stateSet.kernelState(i) == stateSet.kernelState(back)){
-            //If so, delete it and return the old one
-            stateSet.pop();
-            return i;
-        }
+    shifts.symbols.clear();
+    shifts.hashes.clear();
+    shifts.kernels.clear();
+    shifts.kernelStart.assign(1, 0);
+    for (int symbol : workspace.symbols){
+        shifts.symbols.push_back(symbol);
+        shifts.hashes.push_back(LRStateSet::prepare(workspace.shifted[symbol]));
+        shifts.kernels.insert(shifts.kernels.end(), workspace.shifted[symbol].begin(), workspace.shifted[symbol].end());
+        shifts.kernelStart.push_back(shifts.kernels.size());
+        workspace.shifted[symbol].clear();
     }
-    //Otherwise, return the new state
-    return back;
+    workspace.symbols.clear();
 }
 
 //Builds the parse table using item state sets
-void LRParser::makeTable(){
-    //Create a new state set and add a first state
+void LRParser::makeTable(int threads){
+    //Give columns to the end of input, the terminals the grammar uses, and the nonterminals, in that order
+    std::vector<char> used(tokenNum, false);
+    used[0] = true;
+    for (int i=0; i<grammar.size(); i=nextProduction(i)){
+        for (int j=1; j<=grammar[i]; j++){
+            if (isTerminal(grammar[i+j]))
+                used[grammar[i+j]] = true;
+        }
+    }
+    for (int i=0; i<ruleNum; i++){
+        if (i >= tokenNum || used[i])
+            table.addSymbol(i);
+    }
+    //Record the reduction attributes of every production, and which production each grammar position is in
+    itemProd.resize(grammar.size());
+    for (int i=0; i<toRuleCount(ruleNum); i++){
+        int prodNum = 0;
+        for (int r=ruleStart(i); r<ruleStart(i+1); r=nextProduction(r)){
+            int prod = table.addProduction(r, toRuleNum(i), prodNum++, grammar[r]);
+            for (int j=r; j<nextProduction(r); j++){
+                itemProd[j] = prod;
+            }
+        }
+    }
+
+    //Create a new state set. Initialize the first kernel with items corresponding to every production of the starting state (0)
     LRStateSet stateSet;
-    stateSet.newState();
-    //Initialize the first kernel state with items corresponding to every production of the starting state (0)
+    std::vector<uint32_t> kernel;
     for (int i=0; i<ruleStart(1); i=nextProduction(i)){
         LRItem startItem = {i, 0, toRuleNum(0), true};
-        stateSet.kernelState(0).insert(startItem);
-    }
-
-    //Go thru the states in the state set until there is no more
-    for (int curState=0; curState<stateSet.size(); curState++){
-        //For each state, create a corresponding row in the parse table
-        table.newRow();
-        //Run closure operation on the state
-        closure(stateSet, curState);
-        //Array tracking whether a symbol has been reduced while processing this state
-        bool *shifted = new bool[ruleNum];
-        for (int i=0; i<ruleNum; i++){
-            shifted[i] = false;
+        kernel.push_back(packItem(startItem));
+    }
+    stateSet.add(kernel);
+
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    //Batches with fewer states than this per thread aren't worth a thread. Threads take this many states at a time
+    const int minStates = 64;
+    const int block = 16;
+    std::vector<LRWorkspace> workspaces(threads);
+    for (LRWorkspace &workspace : workspaces){
+        workspace.closed.assign(ruleNum, false);
+        workspace.shifted.resize(ruleNum);
+    }
+    //Only the kernels are kept once a batch's rows are done
+    std::vector<LRShifts> batch;
+    //Go thru the states in the state set until there is no more. Each batch is every state found by the one before
+    for (int first=0; first<stateSet.size(); ){
+        int last = stateSet.size();
+        if (batch.size() < last-first)
+            batch.resize(last-first);
+        std::atomic<int> nextState(first);
+        auto work = [&](int k){
+            for (int start=nextState.fetch_add(block); start<last; start=nextState.fetch_add(block)){
+                for (int state=start; state<std::min(start+block, last); state++){
+                    shiftState(stateSet, state, batch[state-first], workspaces[k]);
+                }
+            }
+        };
+        int used = std::min(threads, (last-first) / minStates);
+        std::vector<std::thread> workers;
+        for (int k=1; k<used; k++)
+            workers.push_back(std::thread(work, k));
+        work(0);
+        for (std::thread &worker : workers)
+            worker.join();
+
+        //For each state, create a corresponding row in the parse table and update it with the shifted states,
+        //finding repeats of old states by their kernels
+        for (int state=first; state<last; state++){
+            table.newRow();
+            LRShifts &shifts = batch[state-first];
+            for (int i=0; i<shifts.symbols.size(); i++){
+                const uint32_t *begin = shifts.kernels.data() + shifts.kernelStart[i];
+                const uint32_t *end = shifts.kernels.data() + shifts.kernelStart[i+1];
+                table.shift(state, shifts.symbols[i], stateSet.add(begin, end, shifts.hashes[i]));
+            }
         }
-        //Run the helper function for every item in the current state
-        for (const LRItem &item : stateSet.kernelState(curState)){
-            makeTableHelper(stateSet, item, curState, shifted);
+        first = last;
+    }
+    addReductions(stateSet);
+    table.compress();
+}
+
+//Index of the lowest set bit of a nonzero word
+static inline int lowestBit(uint64_t word){
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+//Runs the digraph traversal from one nonterminal transition. Every set ends up as the union of its own set and the sets of
+//the transitions it can reach. Transitions on a cycle are given the same set
+static void traverse(int x, const std::vector<std::vector<int>> &edges, std::vector<uint64_t> &sets, int words,
+                     std::vector<int> &depth, std::vector<int> &stack){
+    stack.push_back(x);
+    int d = stack.size();
+    depth[x] = d;
+    for (int y : edges[x]){
+        if (depth[y] == 0)
+            traverse(y, edges, sets, words, depth, stack);
+        depth[x] = std::min(depth[x], depth[y]);
+        for (int w=0; w<words; w++)
+            sets[x*words + w] |= sets[y*words + w];
+    }
+    //x is the root of a strongly connected component, which is popped off with x's set
+    if (depth[x] == d){
+        int top;
+        do{
+            top = stack.back();
+            stack.pop_back();
+            depth[top] = INT_MAX;
+            for (int w=0; w<words; w++)
+                sets[top*words + w] = sets[x*words + w];
+        } while (top != x);
+    }
+}
+
+static void digraph(const std::vector<std::vector<int>> &edges, std::vector<uint64_t> &sets, int words){
+    std::vector<int> depth(edges.size(), 0);
+    std::vector<int> stack;
+    for (int x=0; x<edges.size(); x++){
+        if (depth[x] == 0)
+            traverse(x, edges, sets, words, depth, stack);
+    }
+}
+
+//Follows the gotos of the first len rhs symbols of a production
+int LRParser::walk(int state, int prodPos, int len){
+    for (int i=1; i<=len; i++){
+        state = table(state, grammar[prodPos + i]);
+    }
+    return state;
+}
+
+//Lookaheads of a reduction are the Follow sets of the nonterminal transitions it looks back to. Follow sets are built from
+//the terminals read right after each transition, through nullable nonterminals, and the Follow sets of the transitions
+//whose productions end with it. Term sets are bitsets of tokenNum bits
+void LRParser::addReductions(LRStateSet &stateSet){
+    int nonterminals = ruleNum - tokenNum;
+    int words = (tokenNum + 63) / 64;
+    //Find the nullable nonterminals, repeating until no more are found
+    std::vector<char> nullable(ruleNum, false);
+    for (bool changed = true; changed; ){
+        changed = false;
+        for (int i=0; i<nonterminals; i++){
+            for (int r=ruleStart(i); r<ruleStart(i+1) && !nullable[toRuleNum(i)]; r=nextProduction(r)){
+                int j = 1;
+                while (j <= grammar[r] && !isTerminal(grammar[r+j]) && nullable[grammar[r+j]])
+                    j++;
+                if (j > grammar[r]){
+                    nullable[toRuleNum(i)] = true;
+                    changed = true;
+                }
+            }
         }
-        for (const LRItem &item : stateSet.closureState(curState)){
-            makeTableHelper(stateSet, item, curState, shifted);
+    }
+
+    //Number the nonterminal transitions of the table
+    std::vector<int> transState;
+    std::vector<int> transSymbol;
+    std::vector<int> transIndex(table.size()*nonterminals, -1);
+    for (int p=0; p<table.size(); p++){
+        for (int a=tokenNum; a<ruleNum; a++){
+            if (table(p, a) >= 0){
+                transIndex[p*nonterminals + toRuleCount(a)] = transState.size();
+                transState.push_back(p);
+                transSymbol.push_back(a);
+            }
         }
-        delete[] shifted;
     }
-}
+    int count = transState.size();
 
-//Helper function that runs for every item when looping thru an item state.
-//Responsible for performing either reduce or shift on the state for the given item. 
-void LRParser::makeTableHelper(LRStateSet &stateSet, const LRItem &item, int curState, bool* shifted){
-    int symbol = curSymbol(item);
-    //If the item's dot has reached the end of the production, reduce the state for that item.
-    if (symbol == -1){
-        bool accepting;
-        //If the item was initially added to state 0, then its reduction would mean end of parse
-        //Thus, the state is treated as a reduction state instead
-        if (item.isStarting){
-            accepting = true;
+    //Terminals shifted right after each transition, and the transitions reached thru nullable nonterminals.
+    //Both only depend on the state the transition goes to, so each state's shifted terminals are found once
+    std::vector<int> nullables;
+    for (int c=tokenNum; c<ruleNum; c++){
+        if (nullable[c])
+            nullables.push_back(c);
+    }
+    std::vector<uint64_t> shifts(table.size()*words, 0);
+    for (int q=0; q<table.size(); q++){
+        for (int t=0; t<tokenNum; t++){
+            if (table(q, t) >= 0)
+                shifts[q*words + t/64] |= (uint64_t)1 << (t%64);
         }
-        else{
-            accepting = false;
+    }
+    std::vector<uint64_t> follow(count*words, 0);
+    std::vector<std::vector<int>> reads(count);
+    for (int x=0; x<count; x++){
+        int q = table(transState[x], transSymbol[x]);
+        std::copy(shifts.begin() + q*words, shifts.begin() + (q+1)*words, follow.begin() + x*words);
+        for (int c : nullables){
+            if (table(q, c) >= 0)
+                reads[x].push_back(transIndex[q*nonterminals + toRuleCount(c)]);
         }
-        table.reduceState(item.prodPos, item.lhs, findProdNum(item), accepting);
     }
-    //Otherwise, if the dot symbol hasn't been shifted yet, then update the table with the shifted state for that symbol.
-    else if (!shifted[symbol]){
-        shifted[symbol] = true;
-        int transition = shiftSymbol(stateSet, curState, symbol);
-        table(curState, symbol) = transition;
+    digraph(reads, follow, words);
+
+    //A transition includes the transition of a production's lhs when it ends the production, up to nullable symbols.
+    //-1 stands for the starting productions from state 0, which are followed by the end of input instead
+    std::vector<std::vector<int>> includes(count);
+    std::vector<int> path;
+    for (int x=-1; x<count; x++){
+        int lhs = (x == -1) ? toRuleNum(0) : transSymbol[x];
+        for (int r=ruleStart(toRuleCount(lhs)); r<ruleStart(toRuleCount(lhs+1)); r=nextProduction(r)){
+            path.assign(1, (x == -1) ? 0 : transState[x]);
+            for (int j=1; j<=grammar[r]; j++){
+                path.push_back(table(path.back(), grammar[r+j]));
+            }
+            for (int j=grammar[r]; j>=1 && !isTerminal(grammar[r+j]); j--){
+                int y = transIndex[path[j-1]*nonterminals + toRuleCount(grammar[r+j])];
+                if (x == -1)
+                    follow[y*words] |= 1;
+                else includes[y].push_back(x);
+                if (!nullable[grammar[r+j]])
+                    break;
+            }
+        }
     }
-}
+    digraph(includes, follow, words);
 
-int LRParser::findProdNum(const LRItem &item){
-    //Loop thru each production of the item's lhs, while keeping track of the production number
-    int prodNum = 0;
-    for (int i=ruleStart(toRuleCount(item.lhs)); i<ruleStart(toRuleCount(item.lhs+1)); i=nextProduction(i)){
-        //If the right production is found, return it
-        if (i == item.prodPos){
-            return prodNum;
+    //Reduce each production in the state it ends in, under the Follow sets of the transitions it started from. Many
+    //transitions end in the same state, so their sets are merged for each state and production before filling the table
+    std::unordered_map<uint64_t, int> lookaheadIndex;
+    std::vector<uint64_t> lookaheads;
+    std::vector<std::pair<int, int>> reductions;
+    for (int x=0; x<count; x++){
+        int lhs = transSymbol[x];
+        for (int r=ruleStart(toRuleCount(lhs)); r<ruleStart(toRuleCount(lhs+1)); r=nextProduction(r)){
+            int q = walk(transState[x], r, grammar[r]);
+            auto found = lookaheadIndex.emplace((uint64_t)q << 32 | r, reductions.size());
+            if (found.second){
+                reductions.push_back(std::make_pair(q, r));
+                lookaheads.resize(lookaheads.size() + words, 0);
+            }
+            for (int w=0; w<words; w++){
+                lookaheads[found.first->second*words + w] |= follow[x*words + w];
+            }
+        }
+    }
+    for (int i=0; i<reductions.size(); i++){
+        for (int w=0; w<words; w++){
+            for (uint64_t bits=lookaheads[i*words + w]; bits != 0; bits &= bits-1)
+                table.reduce(reductions[i].first, w*64 + lowestBit(bits), itemProd[reductions[i].second], false);
+        }
+    }
+    //Completed starting items accept at the end of input
+    for (int q=0; q<table.size(); q++){
+        for (const uint32_t *i=stateSet.kernelBegin(q); i<stateSet.kernelEnd(q); i++){
+            LRItem item = unpackItem(*i);
+            if (item.isStarting && curSymbol(item) == -1)
+                table.reduce(q, 0, itemProd[item.prodPos], true);
         }
-        prodNum++;
     }
-    return -1;
 }
 
-LRParser::LRParser(char* grammarConfig, Lexer *lexptr) : BaseParserGenerator(grammarConfig, lexptr){
-    makeTable();
+LRParser::LRParser(char* grammarConfig, Lexer *lexptr, int threads) : BaseParserGenerator(grammarConfig, lexptr){
+    makeTable(threads);
 }
 
 LRParser::~LRParser(){
@@ -153,20 +364,43 @@ LRParser::~LRParser(){
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 ParseStatus LRParser::parse(char *input){
-    curpos = input;
-    prevpos = input;
+    setInput(input);
+    return start();
+}
+ParseStatus LRParser::parse(const TokenStream &tokens){
+    setInput(tokens);
+    return start();
+}
+ParseStatus LRParser::parse(InputStream &input){
+    setInput(input);
+    return start();
+}
+ParseStatus LRParser::parse(const char *begin, const char *end){
+    setInput(begin, end);
+    return start();
+}
+ParseStatus LRParser::parse(std::string_view input){
+    //An empty view may have no data, and a NULL end would mean \0-terminated input
+    if (input.empty())
+        input = std::string_view("", 0);
+    return parse(input.data(), input.data() + input.size());
+}
+
+ParseStatus LRParser::start(){
     deleteValues(valueStack.size());
-    lexptr->reset();
     stateStack.clear();
     stateStack.push_back(0);
+    symbolCount = 0;
     curTokenNum = next();
+    curColumn = table.column(curTokenNum);
+    lookaheadState = 0;
     return shiftHelper();
 }
 
 //Advances the parse until a reduction occurs
 ParseStatus LRParser::shiftHelper(){
     //Query the next action in the parse table via the most recent state and the current token
-    int action = table(stateStack.back(), curTokenNum);
+    action = table.action(stateStack.back(), curColumn);
     //Continue while the parse table's next action is a shift action
     while (action >= 0){
         //Push the shifted-to state into the stack and get the next token   
@@ -174,7 +408,9 @@ ParseStatus LRParser::shiftHelper(){
         //Push string value onto value stack
         addParseValue();
         curTokenNum = next();
-        action = table(stateStack.back(), curTokenNum);
+        curColumn = table.column(curTokenNum);
+        lookaheadState = stateStack.back();
+        action = table.action(stateStack.back(), curColumn);
     }
     if (action == -1){
         return SYNTAXERROR;
@@ -182,38 +418,31 @@ ParseStatus LRParser::shiftHelper(){
     else{
         //The # of states to pop off the state stack depends on the # of symbols in the reduced production
         //Set this var here so rhsVal() will work afterwards
-        symbolCount = grammar[table.prodPos(stateStack.back())];
+        symbolCount = table.prodLength(LRTable::reducedProd(action));
         return GOOD;
     }
 }
 
 //Performs a reduction and appends a user-provided value onto the value stack
 ParseStatus LRParser::reduce(void *reducedValue, bool toDelete){
-    int lastState = stateStack.back();
-    //Invoke syntax error if the current state isnt a reduction state
-    if (table.lhsNum(lastState) < 0) return SYNTAXERROR;
+    //Invoke syntax error if no reduction is pending
+    if (action == -1 || stateStack.size() <= symbolCount) return SYNTAXERROR;
     for (int i=0; i<symbolCount; i++){
         stateStack.pop_back();
     }
-    //Replace the popped states with the new state that corresponds to the reduced lhs
-    stateStack.push_back(table(stateStack.back(), table.lhsNum(lastState)));
     //Pop off the same # of values off the value stack and replace with the inputted parse value
     deleteValues(symbolCount);
     valueStack.push_back(ParseValue());
     valueStack.back().toDelete = toDelete;
     valueStack.back().ptr = reducedValue;
 
-    //If the reduced state was an accepting state
-    if (table(lastState, curTokenNum)==-3){
-        //Finish parse if done reading input
-        if (curTokenNum==0)
-            return DONE;
-        //Otherwise, if the parser can parse no more tokens after the accepting lhs has been completed, emit syntax error.
-        //Expected token is \0, since parse should be finished. 
-        if (stateStack.back()==-1){
-            return SYNTAXERROR;
-        }
+    //Accepts are only placed under the end of input, so the parse is finished
+    if (LRTable::isAccept(action)){
+        symbolCount = 0;
+        return DONE;
     }
+    //Replace the popped states with the new state that corresponds to the reduced lhs
+    stateStack.push_back(table.gotoState(stateStack.back(), LRTable::reducedProd(action)));
     return shiftHelper();
 }
 
@@ -242,11 +471,13 @@ void LRParser::deleteValues(int count){
 }
 
 int LRParser::lhsNum(){
-    return toRuleCount(table.lhsNum(stateStack.back()));
+    if (action == -1) return -1;
+    return toRuleCount(table.lhsNum(LRTable::reducedProd(action)));
 }
 
 int LRParser::prodNum(){
-    return table.prodNum(stateStack.back());
+    if (action == -1) return -1;
+    return table.prodNum(LRTable::reducedProd(action));
 }
 
 void *LRParser::rhsVal(int pos){
@@ -260,14 +491,10 @@ int LRParser::curToken(){
 //Returns list of tokens the parser expects at this point in the parse
 std::vector<int> LRParser::expectedTokens(){
     std::vector<int> list;
-    //Having -1 state means that the input was too long, and \0 was expected
-    if (stateStack.back()==-1){
-        list.push_back(0);
-        return list;
-    }
-    //Loop thru all look ahead tokens and add the ones that produce a shift action for the current state
+    //Loop thru all look ahead tokens and add the ones with an action in the state the current token was first looked up in.
+    //Default reductions may have been made on the token since, which would leave fewer tokens in the current state
     for (int i=0; i<tokenNum; i++){
-        if (table(stateStack.back(), i) >= 0){
+        if (table.column(i) != 0 && table.expects(lookaheadState, table.column(i))){
             list.push_back(i);
         }
     }
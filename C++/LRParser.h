@@ -5,42 +5,58 @@
 
 class LRParser : public BaseParserGenerator {
 private:
-    LRTable table{ruleNum};
+    LRTable table{tokenNum, ruleNum};
     //Returns the symbol number right after the dot for a LR item
     int curSymbol(const LRItem &item);
-    //Runs the closure operation on the latest kernel state
-    void closure(LRStateSet &stateSetm, int state);
+    //Maps each position in the grammar to the # of the production it is in, so that packed items can be unpacked
+    std::vector<int> itemProd;
+    //Packs an item into 32 bits as the grammar position of its dot, shifted up one, with the starting flag in the low bit
+    uint32_t packItem(const LRItem &item);
+    LRItem unpackItem(uint32_t packed);
+    //Adds the closure of the kernel items of a state to the list. The closed symbols are cleared again afterwards
+    void closure(std::vector<LRItem> &items, std::vector<char> &closed);
     //Gets called on every LRItem in the parse state during closure
-    void closureHelper(LRStateSet &stateSet, LRItem item, bool *closed, int stateNum);
-    //Runs the shift operation on the latest kernel state for the given symbol
-    int shiftSymbol(LRStateSet &stateSet, int symbolNum, int state);
-    //Makes the LR parse table
-    void makeTable();
-    //Helper function that runs for every item when looping thru an item state.
-    //Responsible for performing either reduce or shift on the state for the given item. 
-    void makeTableHelper(LRStateSet &stateSet, const LRItem &item, int curState, bool* shifted);
-    //Find the production number of the production assiciated with a given item
-    int findProdNum(const LRItem &item);
+    void closureHelper(std::vector<LRItem> &items, LRItem item, std::vector<char> &closed);
+    //Finds the kernels of the states a state shifts to. Only reads the state set, so states can be processed in parallel
+    void shiftState(LRStateSet &stateSet, int state, LRShifts &shifts, LRWorkspace &workspace);
+    //Makes the LR parse table. The LR(0) states are built first, then reductions are added under their LALR(1) lookaheads.
+    //States are numbered in the order they are found, with the symbols of a state shifted in the order they appear in it.
+    //The shifts of all the states found so far are worked out on up to the given # of threads, then interned in state
+    //order, so the table is the same for any # of threads
+    void makeTable(int threads);
+    //Computes LALR(1) lookaheads with the DeRemer-Pennello relations on the nonterminal transitions and fills in reductions
+    void addReductions(LRStateSet &stateSet);
+    //Returns the state reached by following the first len rhs symbols of a production from a state
+    int walk(int state, int prodPos, int len);
 
     //Parse stacks for states and parse values
     std::vector<ParseValue> valueStack;
     std::vector<int> stateStack;
-    //The # of symbols in the currently reduced production
+    //The # of symbols in the currently reduced production and the table action reducing it. -1 when none is pending
     int symbolCount;
-    //Current token
+    int action = -1;
+    //Current token, its column in the table, and the state it was first looked up in
     int curTokenNum;
+    int curColumn;
+    int lookaheadState;
 
     void deleteValues(int count);
     void addParseValue();
     ParseStatus shiftHelper();
+    //Resets the parse stacks and shifts up to the first reduction. Input has to be set beforehand
+    ParseStatus start();
 
 public: 
     friend std::ostream &operator<<(std::ostream &os, LRParser &parser);
-    //Constructs the parse table
-    LRParser(char*, Lexer*);
+    //Constructs the parse table. threads is the most threads to build it with, defaulting to the # of cores
+    LRParser(char*, Lexer*, int threads = 0);
     ~LRParser();
     //Reset all internal variables and initiate parse on a new input. Begin the first reduction
     ParseStatus parse(char *input);
+    ParseStatus parse(const TokenStream &tokens);
+    ParseStatus parse(InputStream &input);
+    ParseStatus parse(const char *begin, const char *end);
+    ParseStatus parse(std::string_view input);
     //Finish a pending reduction and associate the produced lhs symbol with the reduced value. Begin the next reduction
     //Primary means of advancing the parsing
     ParseStatus reduce(void *reducedValue, bool toDelete);
@@ -51,7 +67,7 @@ public:
     //Return pointer to value of a specific rhs value being reduced (0-indexed)
     void *rhsVal(int pos);
     
-    //Returns number of current token, the list of expected tokens (returns -1 for non-shift errors), and the column/line numbers in case parse fails
+    //Returns number of current token, the list of expected tokens, and the column/line numbers in case parse fails
     int curToken();
     std::vector<int> expectedTokens();
 };
\ No newline at end of file
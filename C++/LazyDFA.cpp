@@ -0,0 +1,125 @@
+#include "LazyDFA.h"
+
+//Cache starts out empty. The starting state is added by the first simulation
+regexp::LazyDFA::LazyDFA(const BaseRegexp &re){
+    classCount = re.charClasses(classMap);
+    listids.assign(re.nfa.size(), -1);
+}
+
+//Finds the state for the closed set held in states, caching a new state if the set hasn't been seen
+int regexp::LazyDFA::findState(const BaseRegexp &re){
+    auto found = stateNums.find(states);
+    if (found != stateNums.end())
+        return found->second;
+    if (accepts.size() >= limit)
+        return -1;
+    int num = accepts.size();
+    accepts.push_back(re.setAccept(states));
+    transitions.resize(transitions.size() + classCount, -2);
+    //The \0 class never has transitions
+    transitions[num*classCount + classMap[0]] = -1;
+    stateNums[states] = num;
+    stateSets.push_back(states);
+    return num;
+}
+
+//Follows the char edges of every NFA state in the set for a char class, then closes the result
+int regexp::LazyDFA::computeTransition(const BaseRegexp &re, int state, int cls){
+    //Any char of the class works, since they all behave the same
+    int c = 1;
+    while (classMap[c] != cls)
+        c++;
+    states.clear();
+    id++;
+    for (int nfaState : stateSets[state]){
+        int edge = re.nfa.edge[nfaState];
+        if (re.nfa.transitions(nfaState)[c] && listids[edge] != id){
+            listids[edge] = id;
+            states.push_back(edge);
+        }
+    }
+    //An empty set is the dead state
+    int next = -1;
+    if (!states.empty()){
+        re.closure(states, listids, id);
+        next = findState(re);
+        if (next < 0)
+            return -2;
+    }
+    transitions[state*classCount + cls] = next;
+    return next;
+}
+
+void regexp::LazyDFA::flush(){
+    transitions.clear();
+    accepts.clear();
+    stateSets.clear();
+    stateNums.clear();
+    counters.flushes++;
+}
+
+//Runs the DFA from the cache, computing missing states and transitions as they are needed.
+//If the cache fills up, it is flushed and the simulation is redone on the NFA. So is a simulation that finds the cache in use
+int regexp::LazyDFA::simulate(const BaseRegexp &re, char* &str, MatchContext &context, const char* end, bool *hitEnd){
+    std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock())
+        return re.simulateNFA(str, context, end, hitEnd);
+    if (hitEnd != NULL)
+        *hitEnd = false;
+    //Starting state is always state 0 when the cache isn't empty
+    if (accepts.empty()){
+        states.clear();
+        states.push_back(re.starting);
+        re.closure(states, listids, ++id);
+        findState(re);
+    }
+    int state = 0;
+    ptrdiff_t lastAcceptPos = 0;
+    int lastAcceptState = accepts[0];
+    for (ptrdiff_t i=0; ; i++){
+        //The scan was still going at the end of a bounded input, so more input could change the token
+        if (str+i == end){
+            if (hitEnd != NULL)
+                *hitEnd = true;
+            break;
+        }
+        unsigned char c = str[i];
+        if (c >= NumOfChars)
+            break;
+        int cls = classMap[c];
+        int next = transitions[state*classCount + cls];
+        if (next == -2){
+            counters.misses++;
+            next = computeTransition(re, state, cls);
+            if (next == -2){
+                flush();
+                return re.simulateNFA(str, context, end, hitEnd);
+            }
+        }
+        else counters.hits++;
+        if (next < 0)
+            break;
+        state = next;
+        if (accepts[state] > -1){
+            lastAcceptPos = i+1;
+            lastAcceptState = accepts[state];
+        }
+    }
+    str += lastAcceptPos;
+    return lastAcceptState;
+}
+
+regexp::CacheStats regexp::LazyDFA::stats(){
+    std::lock_guard<std::mutex> lock(mutex);
+    CacheStats current = counters;
+    current.states = accepts.size();
+    return current;
+}
+
+//Changing the limit empties the cache, so it never holds more states than the limit
+void regexp::LazyDFA::setLimit(size_t states){
+    std::lock_guard<std::mutex> lock(mutex);
+    limit = (states > 0) ? states : 1;
+    if (!accepts.empty())
+        flush();
+}
@@ -0,0 +1,53 @@
+#ifndef LAZYDFA_H
+#define LAZYDFA_H
+
+#include "Regexp.h"
+#include <vector>
+#include <map>
+#include <mutex>
+
+namespace regexp{
+    // DFA that is built on demand while the NFA is simulated. States are made from NFA state sets the first time a
+    // simulation reaches them, and their transitions are filled in the first time they are taken.
+    // The cache is bounded. Once it is full it is flushed, and the simulation that filled it is finished by the NFA.
+    // The cache is shared by every thread using the regexp. A thread that finds it in use runs the NFA instead of waiting
+    class LazyDFA{
+    private:
+        // Transition table indexed by state * classCount + char class. -1 means no transition, -2 means not computed yet
+        std::vector<int> transitions;
+        // Accept value of each state. -1 means no accept
+        std::vector<int> accepts;
+        // NFA state set of each cached state, and the map used to find a state by its set
+        std::vector<std::vector<int>> stateSets;
+        std::map<std::vector<int>, int> stateNums;
+        // Char classes, same as the ones used by the full DFA
+        unsigned char classMap[NumOfChars];
+        int classCount;
+        // Max number of cached states
+        size_t limit = 1024;
+        // Scratch space for computing state sets
+        std::vector<int> listids;
+        std::vector<int> states;
+        int id = 0;
+        CacheStats counters;
+        // Guards everything above
+        std::mutex mutex;
+
+        // Returns the cached state for a closed NFA state set. Returns -1 if the cache is full
+        int findState(const BaseRegexp &re);
+        // Computes the transition of a cached state for a char class. Returns -2 if the cache is full
+        int computeTransition(const BaseRegexp &re, int state, int cls);
+        // Empties the cache
+        void flush();
+
+    public:
+        LazyDFA(const BaseRegexp &re);
+        // Runs the cached DFA on a string input, obeying maximal munch. Same contract as BaseRegexp::simulate.
+        // The context is only used if the simulation falls back to the NFA
+        int simulate(const BaseRegexp &re, char* &str, MatchContext &context, const char* end = NULL, bool *hitEnd = NULL);
+        CacheStats stats();
+        void setLimit(size_t states);
+    };
+}
+
+#endif
@@ -1,12 +1,18 @@
 #include "Lexer.h"
+#include "DFA.h"
+#include "KeywordTable.h"
+#include <thread>
+#include <memory>
+#include <algorithm>
+#include <cstring>
 
 //Lexer has multiple accept states, so the accept state table is queried to see which the regexp number the acceptance corresponds with
-int Lexer::isAccepting(int state){
+int Lexer::isAccepting(int state) const{
     return acceptTable[state];
 }
 
 //Lexer builds multiple regexps into a large NFA with multiple accepts
-Lexer::Lexer(char* regexplist[], int len, int newlineToken=-1){
+Lexer::Lexer(char* regexplist[], int len, int newlineToken=-1, Engine::Engine engine, bool fold){
     //Invalid construction for empty regexp list
     if (len == 0){
         //Offset destructor
@@ -15,66 +21,341 @@ Lexer::Lexer(char* regexplist[], int len, int newlineToken=-1){
         return;
     }
 
-    //Accept list maps the regexp numbers to the accept state numbers. To be transformed into acceptTable 
-    int* acceptList = new int[len];
+    //Regexp numbers of the regexps built into the NFA. Folded keywords are left out
+    std::vector<int> kept;
+    if (fold)
+        kept = foldKeywords(regexplist, len);
+    else for (int i=0; i<len; i++)
+        kept.push_back(i);
+    //Accept list maps the kept regexps to the accept state numbers. To be transformed into acceptTable 
+    int* acceptList = new int[kept.size()];
     //Build the first regexp as NFA
     RegexpBuilder builder;
-    builder.build(regexplist[0], this, starting, acceptList[0]);
+    builder.build(regexplist[kept[0]], this, starting, acceptList[0]);
     //For each subsequent regexp, build a new NFA and alternate it to the previous one
-    for (int i=1; i<len; i++){
+    for (int i=1; i<kept.size(); i++){
         int startR, acceptR;
         RegexpBuilder builder;
-        builder.build(regexplist[i], this, startR, acceptList[i]);
+        builder.build(regexplist[kept[i]], this, startR, acceptList[i]);
         acceptR = acceptList[i];
         builder.alternate(startR, acceptR, starting, acceptList[i-1]);
         //Pop off the extra end state, which isn't needed since we can allow multiple accept states
         nfa.pop_back();
         starting = startR;
     }
+    std::vector<int> newNum;
+    layout(newNum);
+    for (int i=0; i<kept.size(); i++)
+        acceptList[i] = newNum[acceptList[i]];
 
     //Default all acceptTable values to -1 (no accept)
     acceptTable = new int[nfa.size()];
     for (int i=0; i<nfa.size(); i++)
         acceptTable[i] = -1;
     //For each accept state, map it to its regexp number
-    for (int i=0; i<len; i++)
-        acceptTable[acceptList[i]] = i;
+    for (int i=0; i<kept.size(); i++)
+        acceptTable[acceptList[i]] = kept[i];
 
     this->newlineToken = newlineToken;
     delete[] acceptList;
+    compile(engine);
 }
 
-//Parses the next token in the input and stores its info. Returns pointer to char after end of token
-char* Lexer::lex(char* input){
+//A keyword is a regexp of only letters, digits and _, none of which are special, so it matches exactly itself.
+//It can be folded into the lowest numbered other regexp that matches it, as long as that regexp comes after the keyword.
+//Then wherever the keyword would have won, the host matches the same lexeme at the same length and wins in its place,
+//since no regexp before the host matches the keyword. The lookup turns it back into the keyword.
+//Keywords after their host never win, so they are left alone, the same as before
+std::vector<int> Lexer::foldKeywords(char* regexplist[], int len){
+    const char *wordChars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_";
+    std::vector<char> literal(len);
+    for (int i=0; i<len; i++){
+        size_t length = strlen(regexplist[i]);
+        literal[i] = length > 0 && strspn(regexplist[i], wordChars) == length;
+    }
+    std::vector<int> kept;
+    std::vector<std::unique_ptr<Regexp>> built(len);
+    for (int i=0; i<len; i++){
+        int host = -1;
+        for (int m=0; m<len && literal[i] && host < 0; m++){
+            if (m == i)
+                continue;
+            if (literal[m]){
+                if (strcmp(regexplist[m], regexplist[i]) == 0)
+                    host = m;
+                continue;
+            }
+            if (built[m] == NULL)
+                built[m].reset(new Regexp(regexplist[m]));
+            const char *keyword = regexplist[i];
+            size_t length = strlen(keyword);
+            if (built[m]->match(keyword, keyword + length) == length)
+                host = m;
+        }
+        if (host > i && !literal[host]){
+            if (keywords == NULL)
+                keywords = new regexp::KeywordTable();
+            keywords->add(regexplist[i], i, host);
+        }
+        else kept.push_back(i);
+    }
+    if (keywords != NULL)
+        keywords->build();
+    return kept;
+}
+
+//Generated lexers have no NFA, so the accept table is left empty
+Lexer::Lexer(regexp::LexFunction function, int newlineToken){
+    acceptTable = new int[0];
+    this->function = function;
+    this->newlineToken = newlineToken;
+}
+
+//Parses the next token in the input and stores its info in the context. Returns pointer to char after end of token
+char* Lexer::lex(char* input, LexContext &context, const char* end) const{
     //Don't advance input if lexer was created with no regexp
     if (newlineToken == -100){
         return input;
     }
     char* curpos = input;
     //Run simulation, which advances the curpos pointer and produces the token id
-    tokenID = simulate(curpos);
-    if (tokenID == newlineToken){
-        tokenLine++;
-        tokenCol = 1;
+    if (function != NULL){
+        const char* matchEnd;
+        context.tokenID = function(input, end, &matchEnd);
+        curpos = (char*)matchEnd;
     }
-    else{
-        tokenCol += curpos-input;
+    else if (linear){
+        context.memo.advance(input, end, dfa->size());
+        context.tokenID = dfa->simulate(curpos, end, &context.memo);
     }
+    else context.tokenID = simulate(curpos, context, end);
+    if (keywords != NULL && context.tokenID > -1)
+        context.tokenID = keywords->find(input, curpos-input, context.tokenID);
     return curpos;
 }
 
+char* Lexer::lex(char* input){
+    return lex(input, context);
+}
+
+//The token is lexed against the end of the buffer. If the scan could have gone on, the buffer is filled and the token lexed again
+char* Lexer::lex(InputStream &input, char* &pos, LexContext &context) const{
+    if (newlineToken == -100)
+        return pos;
+    while (true){
+        //A generated lexer doesn't report where its scan stopped, so it is only run with a chunk of input after pos
+        if (function != NULL){
+            if (input.atEOF() || (input.end() - pos) >= input.chunk())
+                return lex(pos, context, input.end());
+            pos = input.fill(pos);
+            continue;
+        }
+        char* curpos = pos;
+        bool hitEnd = false;
+        if (linear){
+            context.memo.advance(pos, input.end(), dfa->size(), input.fillId());
+            context.tokenID = dfa->simulate(curpos, input.end(), &context.memo, &hitEnd);
+        }
+        else context.tokenID = simulate(curpos, context, input.end(), &hitEnd);
+        //Memo entries are dropped by the next advance(), since the fill changes the buffer
+        if (hitEnd && !input.atEOF()){
+            pos = input.fill(pos);
+            continue;
+        }
+        if (keywords != NULL && context.tokenID > -1)
+            context.tokenID = keywords->find(pos, curpos-pos, context.tokenID);
+        return curpos;
+    }
+}
+
+//Runs the lexer over the whole input in one loop, appending every kept token to the stream.
+//Follows the same rules as the parsers' next(): when no token or only an empty one matches, the char is its own token
+TokenStream Lexer::tokenizeAll(const char* begin, const char* end, const std::vector<char> &ignore) const{
+    TokenStream stream;
+    stream.base = begin;
+    stream.length = end - begin;
+    LexContext context;
+    char* curpos = (char*)begin;
+    while (curpos < end){
+        char* prevpos = curpos;
+        curpos = lex(curpos, context, end);
+        int id = context.tokenID;
+        if (id < 0 || curpos == prevpos){
+            id = -1;
+            curpos++;
+        }
+        else if (id < ignore.size() && ignore[id]){
+            continue;
+        }
+        stream.ids.push_back(id);
+        stream.starts.push_back(prevpos - begin);
+        stream.lengths.push_back(curpos - prevpos);
+    }
+    return stream;
+}
+
+//Tokens lexed by one thread of tokenizeParallel(), as offsets from the start of input. Kept before ignored tokens are dropped.
+//next is where the following token starts. id is the token's regexp number, or -1 for a char lexed as its own token
+struct ChunkTokens{
+    std::vector<size_t> starts;
+    std::vector<size_t> nexts;
+    std::vector<int> ids;
+};
+
+//Chunks are lexed in parallel up to the start of the next chunk. Then the true token boundary is followed from the start of
+//input. A chunk token starting right on it is correct, since lexing from a token start doesn't depend on what came before,
+//and so is every chunk token after it. Until then the chunk is lexed again here, which usually only takes a token or two.
+//Finally the chunks are counted and copied into the stream in parallel, the same way tokenizeAll() would have stored them
+TokenStream Lexer::tokenizeParallel(const char* begin, const char* end, int threads, const std::vector<char> &ignore) const{
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    //Chunks smaller than this aren't worth a thread
+    const size_t minChunk = 1 << 16;
+    size_t length = end - begin;
+    threads = (int)std::min((size_t)threads, length / minChunk);
+    if (threads <= 1 || newlineToken == -100)
+        return tokenizeAll(begin, end, ignore);
+
+    //Runs a step for every chunk, with the first chunk on this thread
+    auto forEachChunk = [threads](auto step){
+        std::vector<std::thread> workers;
+        for (int k=1; k<threads; k++)
+            workers.push_back(std::thread(step, k));
+        step(0);
+        for (std::thread &worker : workers)
+            worker.join();
+    };
+    //Lexes the token at an offset with the same rules as tokenizeAll(), and appends it to a list
+    auto lexOne = [&](size_t pos, LexContext &context, ChunkTokens &tokens){
+        char* prevpos = (char*)begin + pos;
+        char* curpos = lex(prevpos, context, end);
+        int id = context.tokenID;
+        if (id < 0 || curpos == prevpos){
+            id = -1;
+            curpos++;
+        }
+        tokens.starts.push_back(pos);
+        tokens.nexts.push_back(curpos - begin);
+        tokens.ids.push_back(id);
+    };
+
+    //Chunks start after the first newline past an even split of the input
+    std::vector<size_t> splits(threads+1, length);
+    splits[0] = 0;
+    for (int k=1; k<threads; k++){
+        const char* guess = begin + length / threads * k;
+        const char* newline = (const char*)memchr(guess, '\n', end-guess);
+        splits[k] = std::max(splits[k-1], (newline == NULL) ? length : (size_t)(newline+1 - begin));
+    }
+    std::vector<ChunkTokens> chunks(threads);
+    forEachChunk([&](int k){
+        LexContext context;
+        for (size_t pos = splits[k]; pos < splits[k+1]; pos = chunks[k].nexts.back())
+            lexOne(pos, context, chunks[k]);
+    });
+
+    //Tokens of each chunk lexed again before it was in sync, and the first chunk token used after that
+    std::vector<ChunkTokens> relexed(threads);
+    std::vector<size_t> synced(threads);
+    LexContext context;
+    size_t pos = 0;
+    for (int k=0; k<threads; k++){
+        ChunkTokens &tokens = chunks[k];
+        size_t j = 0;
+        while (pos < splits[k+1]){
+            while (j < tokens.starts.size() && tokens.starts[j] < pos)
+                j++;
+            if (j < tokens.starts.size() && tokens.starts[j] == pos)
+                break;
+            lexOne(pos, context, relexed[k]);
+            pos = relexed[k].nexts.back();
+        }
+        synced[k] = (pos < splits[k+1]) ? j : tokens.starts.size();
+        if (synced[k] < tokens.starts.size())
+            pos = tokens.nexts.back();
+    }
+
+    //Runs a step on each token of a chunk in order, the relexed ones first
+    auto forEachToken = [&](int k, auto step){
+        for (size_t i=0; i<relexed[k].starts.size(); i++)
+            step(relexed[k], i);
+        for (size_t i=synced[k]; i<chunks[k].starts.size(); i++)
+            step(chunks[k], i);
+    };
+    auto kept = [&](int id){
+        return !(id > -1 && id < ignore.size() && ignore[id]);
+    };
+    //# of tokens kept in each chunk, summed into where each chunk's tokens go
+    std::vector<size_t> counts(threads+1, 0);
+    forEachChunk([&](int k){
+        forEachToken(k, [&](const ChunkTokens &tokens, size_t i){
+            counts[k+1] += kept(tokens.ids[i]);
+        });
+    });
+    for (int k=0; k<threads; k++)
+        counts[k+1] += counts[k];
+
+    TokenStream stream;
+    stream.base = begin;
+    stream.length = length;
+    stream.ids.resize(counts[threads]);
+    stream.starts.resize(counts[threads]);
+    stream.lengths.resize(counts[threads]);
+    forEachChunk([&](int k){
+        size_t index = counts[k];
+        forEachToken(k, [&](const ChunkTokens &tokens, size_t i){
+            if (!kept(tokens.ids[i]))
+                return;
+            stream.ids[index] = tokens.ids[i];
+            stream.starts[index] = tokens.starts[i];
+            stream.lengths[index] = tokens.nexts[i] - tokens.starts[i];
+            index++;
+        });
+    });
+    return stream;
+}
+
+TokenStream Lexer::tokenizeAll(std::string_view input, const std::vector<char> &ignore) const{
+    return tokenizeAll(input.data(), input.data() + input.size(), ignore);
+}
+
+TokenStream Lexer::tokenizeParallel(std::string_view input, int threads, const std::vector<char> &ignore) const{
+    return tokenizeParallel(input.data(), input.data() + input.size(), threads, ignore);
+}
+
+size_t TokenStream::size() const{
+    return ids.size();
+}
+
+void Lexer::linearMunch(bool on){
+    //Lexer with no regexp or a generated one never simulates anything
+    if (newlineToken == -100 || function != NULL)
+        return;
+    if (on && dfa == NULL)
+        dfa = new regexp::DFA(*this);
+    linear = on;
+}
+
 void Lexer::reset(){
-    tokenLine = 1;
-    tokenCol = 1;
-    tokenID = -1;
+    context.reset();
 }
 
 bool Lexer::good(){
+    return context.good();
+}
+
+void LexContext::reset(){
+    tokenID = -1;
+    memo.reset();
+}
+
+bool LexContext::good(){
     return (tokenID > -1);
 }
 
 Lexer::~Lexer(){
     delete[] acceptTable;
+    delete keywords;
 }
 
 //Lexer cout overload adds all the accepting states
@@ -92,5 +373,5 @@ std::ostream& operator<<(std::ostream& os, const Lexer& regexp){
 //     Lexer lexer = Lexer(argv+1, 2, 0);
 //     std::cout << lexer;
 //     int location = lexer.lex(argv[3]) - argv[3];
-//     std::cout << location << ' ' << lexer.tokenLine << ' ' << lexer.tokenCol << ' ' << lexer.tokenID;
+//     std::cout << location << ' ' << lexer.tokenID;
 // }
\ No newline at end of file
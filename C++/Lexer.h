@@ -2,7 +2,38 @@
 #define LEXER_H
 
 #include "Regexp.h"
+#include "InputStream.h"
+#include "KeywordTable.h"
 #include <iostream>
+#include <vector>
+
+// Lexing state of one input: scratch space for the simulation plus the regexp number of the current token.
+// Each thread lexing with a shared Lexer keeps its own context. Lines and columns aren't tracked while lexing.
+// They are found from token positions when needed, with a LineIndex over the input
+struct LexContext : public regexp::MatchContext{
+    //The regexp number of the current token
+    int tokenID = -1;
+    //Failed pairs for linear-time lexing. Dropped whenever a token doesn't start where the last one ended, so a context
+    //can be reused for new input. Input rewritten in place ahead of the last token still needs reset()
+    regexp::MunchMemo memo;
+    //Resets token variables
+    void reset();
+    //Checks if currently parsed token is valid via tokenID
+    bool good();
+};
+
+// Every token of an input, lexed ahead of parsing. Stored as parallel arrays indexed by token number.
+// Ignored tokens are left out. A char that no regexp matches becomes a token of its own with ID -1 and length 1
+struct TokenStream{
+    //Start and length of the lexed input. Token starts are offsets from the start, and a LineIndex over base gives their lines
+    const char *base = NULL;
+    size_t length = 0;
+    //Regexp number, start offset and length of each token. Offsets and lengths are size_t so inputs over 2GB fit
+    std::vector<int> ids;
+    std::vector<size_t> starts;
+    std::vector<size_t> lengths;
+    size_t size() const;
+};
 
 // Class for storing a sequence of regexps as a large NFA with multiple acceptances in order to perform efficient lexical analysis
 // with token stream as output
@@ -11,26 +42,63 @@ private:
     //Acceptances represented by a table indexed by NFA state numbers. 
     //Contents represent the number of the regexp accepted by each state. -1 means no accept. 
     int* acceptTable;
-    //Specifies the number of the one regex in the lexer whose output token is to be ignored
+    //Number of the regexp matching newlines. Lines are counted from the input itself, so it only marks a lexer
+    //built with no regexps, which has it set to -100
     int newlineToken;
-    int isAccepting(int state);
+    //Whether lex() remembers failed scans so that no input takes more than linear time
+    bool linear = false;
+    //Compiled lexer function used instead of an automaton, such as one made by generateLexer(). NULL if there is none
+    regexp::LexFunction function = NULL;
+    //Keywords left out of the NFA and matched by an identifier regexp instead. NULL if none were folded
+    regexp::KeywordTable *keywords = NULL;
+    int isAccepting(int state) const;
+    //Finds the keywords that can be folded into identifier regexps and adds them to the keyword table.
+    //Returns the regexp numbers of the rest, which are built into the NFA
+    std::vector<int> foldKeywords(char* regexplist[], int len);
 
 public:
-    //Constructor takes array of regexps and builds NFA.
-    Lexer(char* regexplist[], int len, int newlineToken);
+    //Constructor takes array of regexps and builds NFA, then the automaton of the selected engine.
+    //Tokens matched by several regexps at the same length go to the regexp with the lowest index.
+    //Unless fold is false, literal keywords listed before an identifier regexp that matches them are found with a perfect
+    //hash on the identifier's lexeme instead of being built into the NFA. Tokens come out the same either way
+    Lexer(char* regexplist[], int len, int newlineToken, Engine::Engine engine = Engine::NFA, bool fold = true);
+    //Constructor for a lexer that was generated ahead of time. Skips building the NFA
+    Lexer(regexp::LexFunction function, int newlineToken);
     //Performs lexical analysis by processing the next token in the string and returns pointer to the char after the end of the token
+    //Token info is stored in the context. Doesn't modify the lexer, so any number of threads can lex with it at once
+    //The input ends at end, or at \0 if end is NULL
+    char* lex(char* input, LexContext &context, const char* end = NULL) const;
+    //Same as above, storing token info in the lexer's own context
     char* Lexer::lex(char* input);
+    //Lexes the token at pos in the buffer of a stream. When the token could run past what has been read, the input before
+    //pos is dropped and more is read, which moves pos along with the buffer. Returns the end of the token, which is pos
+    //at the end of input. Tokens are carried across chunks exactly by every engine. A generated lexer function can't tell
+    //whether it ran out of input, so it is given at least a chunk of input after pos and longer tokens can be cut short
+    char* lex(InputStream &input, char* &pos, LexContext &context) const;
+    //Lexes a whole input at once. Tokens whose regexp number is set in ignore are dropped
+    TokenStream tokenizeAll(const char* begin, const char* end, const std::vector<char> &ignore = std::vector<char>()) const;
+    //Same as above, lexing chunks of the input on separate threads. Each chunk starts after a newline on the guess that a
+    //token starts there, and only the tokens of a chunk that the guess got wrong are lexed again. The result is the same
+    //as tokenizeAll(). threads defaults to the # of cores
+    TokenStream tokenizeParallel(const char* begin, const char* end, int threads = 0,
+        const std::vector<char> &ignore = std::vector<char>()) const;
+    //Same as the above two, lexing a view such as a mapped file in place
+    TokenStream tokenizeAll(std::string_view input, const std::vector<char> &ignore = std::vector<char>()) const;
+    TokenStream tokenizeParallel(std::string_view input, int threads = 0, const std::vector<char> &ignore = std::vector<char>()) const;
     ~Lexer();
+    //Turns on linear-time maximal munch. Scans that ran past the end of a token without reaching another accept are
+    //remembered, so later tokens don't rescan the same input. Builds the DFA if the lexer doesn't use one already
+    void linearMunch(bool on);
     //Resets token variables
     void reset();
     //Checks if currently parsed token is valid via tokenID
     bool good();
     friend std::ostream& operator<<(std::ostream& os, const Lexer& regexp);
+    friend void generateLexer(char* regexplist[], int len, const std::string &name, std::ostream &out);
 
-    //The line number, column number, and the regexp number of the current token
-    int tokenLine = 1;
-    int tokenCol = 1;
-    int tokenID = -1;
+    //Context used by lex(char*). The token variable below refers to it
+    LexContext context;
+    int &tokenID = context.tokenID;
 };
 
 #endif
\ No newline at end of file
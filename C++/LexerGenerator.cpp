@@ -0,0 +1,92 @@
+#include "LexerGenerator.h"
+#include "DFA.h"
+#include <algorithm>
+
+//Writes a regexp into a comment, escaping chars that would break it such as newlines
+static void writeEscaped(std::ostream &out, const char *str){
+    static const char hex[] = "0123456789abcdef";
+    for (const char *c = str; *c != 0; c++){
+        if (*c >= ' ' && *c < 127)
+            out << *c;
+        else
+            out << "\\x" << hex[(*c >> 4) & 15] << hex[*c & 15];
+    }
+}
+
+//Each state is a label that records the state's accept value, then switches on the next char. Chars with the same
+//target state share a case list, and chars without a transition, including \0, go to the exit
+void generateLexer(char* regexplist[], int len, const std::string &name, std::ostream &out){
+    //Built before anything is written, so a syntax error leaves the output untouched
+    //Keywords stay in the DFA, since the generated code has no keyword table
+    Lexer lexer(regexplist, len, -1, Engine::DFA, false);
+    out << "// Generated by generateLexer(). Do not edit\n";
+    out << "// Regexps by token number:\n";
+    for (int i=0; i<len; i++){
+        out << "//   " << i << ": ";
+        writeEscaped(out, regexplist[i]);
+        out << '\n';
+    }
+    out << '\n';
+    out << "int " << name << "(const char* str, const char* end, const char** matchEnd){\n";
+    //With no regexps nothing ever matches
+    if (len == 0){
+        out << "    *matchEnd = str;\n";
+        out << "    return -1;\n";
+        out << "}\n";
+        return;
+    }
+    out << "    const char* p = str;\n";
+    out << "    int accept = -1;\n";
+    out << "    const char* acceptEnd = str;\n";
+
+    regexp::DFA &dfa = *lexer.dfa;
+    //Only states that are jumped to get a label, so the output compiles without unused label warnings
+    std::vector<char> targeted(dfa.size(), 0);
+    for (int state=0; state<dfa.size(); state++){
+        for (int cls=0; cls<dfa.classes(); cls++){
+            if (dfa(state, cls) >= 0)
+                targeted[dfa(state, cls)] = 1;
+        }
+    }
+    out << "    unsigned char c;\n";
+    for (int state=0; state<dfa.size(); state++){
+        if (targeted[state])
+            out << "s" << state << ":\n";
+        if (dfa.accept(state) > -1){
+            out << "    accept = " << dfa.accept(state) << ";\n";
+            out << "    acceptEnd = p;\n";
+        }
+        out << "    if (p == end) goto done;\n";
+        out << "    c = *p++;\n";
+        out << "    switch (c){\n";
+        //Targets in the order their first char appears, so the output is the same on every run
+        std::vector<int> targets;
+        for (int c=1; c<NumOfChars; c++){
+            int target = dfa(state, dfa.charClass(c));
+            if (target >= 0 && std::find(targets.begin(), targets.end(), target) == targets.end())
+                targets.push_back(target);
+        }
+        for (int target : targets){
+            out << "   ";
+            int onLine = 0;
+            for (int c=1; c<NumOfChars; c++){
+                if (dfa(state, dfa.charClass(c)) != target)
+                    continue;
+                if (onLine == 12){
+                    out << "\n   ";
+                    onLine = 0;
+                }
+                out << " case " << c << ':';
+                onLine++;
+            }
+            out << "\n        goto s" << target << ";\n";
+        }
+        out << "    default:\n";
+        out << "        goto done;\n";
+        out << "    }\n";
+    }
+    out << "done:\n";
+    out << "    *matchEnd = acceptEnd;\n";
+    out << "    return accept;\n";
+    out << "}\n";
+}
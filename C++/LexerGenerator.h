@@ -0,0 +1,14 @@
+#ifndef LEXERGENERATOR_H
+#define LEXERGENERATOR_H
+
+#include "Lexer.h"
+#include <iostream>
+#include <string>
+
+// Writes a self-contained C++ source file for a lexer, so that it can be compiled in instead of built at startup.
+// The regexps are given the same way as to the Lexer constructor. Their minimized DFA is written as a function with one
+// label per state and a switch on each char. The function is a regexp::LexFunction named name, which can be passed
+// to Lexer's generated-lexer constructor. Throws RegexSyntaxError like the Lexer constructor
+void generateLexer(char* regexplist[], int len, const std::string &name, std::ostream &out);
+
+#endif
@@ -0,0 +1,74 @@
+#include "LineIndex.h"
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//16 bytes are compared at once. Blocks with no newline, which is nearly all of them, cost one compare and one test
+size_t LineIndex::countNewlines(const char *begin, const char *end, const char* &lineStart){
+    size_t count = 0;
+    const char *p = begin;
+#ifdef __SSE2__
+    __m128i newline = _mm_set1_epi8('\n');
+    for (; p+16 <= end; p += 16){
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), newline));
+        if (mask == 0)
+            continue;
+        int last = 15;
+        while (!(mask & (1u << last)))
+            last--;
+        lineStart = p + last + 1;
+        for (; mask != 0; mask &= mask-1)
+            count++;
+    }
+#endif
+    for (; p < end; p++){
+        if (*p == '\n'){
+            lineStart = p+1;
+            count++;
+        }
+    }
+    return count;
+}
+
+void LineIndex::reset(const char *base){
+    this->base = base;
+    newlines.clear();
+    scanned = 0;
+}
+
+//Same block scan as countNewlines(), recording each newline found
+size_t LineIndex::scanTo(const char *pos){
+    size_t target = pos - base;
+    if (target > scanned){
+        const char *p = base + scanned;
+        const char *end = pos;
+#ifdef __SSE2__
+        __m128i newline = _mm_set1_epi8('\n');
+        for (; p+16 <= end; p += 16){
+            unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), newline));
+            for (int i=0; mask != 0; i++, mask >>= 1){
+                if (mask & 1)
+                    newlines.push_back(p+i - base);
+            }
+        }
+#endif
+        for (; p < end; p++){
+            if (*p == '\n')
+                newlines.push_back(p - base);
+        }
+        scanned = target;
+    }
+    return std::lower_bound(newlines.begin(), newlines.end(), target) - newlines.begin();
+}
+
+long long LineIndex::line(const char *pos){
+    return scanTo(pos) + 1;
+}
+
+long long LineIndex::column(const char *pos){
+    size_t before = scanTo(pos);
+    if (before == 0)
+        return pos - base;
+    return pos - base - (newlines[before-1] + 1);
+}
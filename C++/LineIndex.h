@@ -0,0 +1,30 @@
+#ifndef LINEINDEX_H
+#define LINEINDEX_H
+
+#include <vector>
+#include <cstddef>
+
+// Offsets of the newlines in an input, found on demand so that lexing never has to count lines. Every \n counts,
+// including ones inside tokens. A query scans the input from where the last one stopped up to the queried position,
+// so positions are only ever scanned once, and \0-terminated input is never read past a position that was asked about
+class LineIndex{
+private:
+    const char *base = NULL;
+    //Offsets from base of the newlines found so far, and the # of bytes scanned for them
+    std::vector<size_t> newlines;
+    size_t scanned = 0;
+    //Scans up to pos. Returns the # of newlines before pos
+    size_t scanTo(const char *pos);
+
+public:
+    //Counts the newlines in a range. Sets lineStart to just after the last one, and leaves it as is if there are none
+    static size_t countNewlines(const char *begin, const char *end, const char* &lineStart);
+    //Starts indexing a new input
+    void reset(const char *base);
+    //Line of a position in the input, counting from 1
+    long long line(const char *pos);
+    //# of chars on the line of a position before it
+    long long column(const char *pos);
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "MappedFile.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//The file is closed once it is mapped, since the mapping keeps its contents reachable
+MappedFile::MappedFile(const char *path){
+    //Empty files can't be mapped, so they are given an empty string instead
+    data = "";
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)){
+        CloseHandle(file);
+        return;
+    }
+    if (fileSize.QuadPart > 0){
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != NULL){
+            void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (view != NULL){
+                data = (const char*)view;
+                length = fileSize.QuadPart;
+                mapped = true;
+            }
+            CloseHandle(mapping);
+        }
+        opened = mapped;
+    }
+    else opened = true;
+    CloseHandle(file);
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat info;
+    if (fstat(fd, &info) != 0){
+        close(fd);
+        return;
+    }
+    if (info.st_size > 0){
+        void *view = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED){
+            //Lexing reads the file front to back
+            madvise(view, info.st_size, MADV_SEQUENTIAL);
+            data = (const char*)view;
+            length = info.st_size;
+            mapped = true;
+        }
+        opened = mapped;
+    }
+    else opened = true;
+    close(fd);
+#endif
+}
+
+MappedFile::~MappedFile(){
+    if (!mapped)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap((void*)data, length);
+#endif
+}
+
+bool MappedFile::ok() const{
+    return opened;
+}
+
+const char* MappedFile::begin() const{
+    return data;
+}
+
+const char* MappedFile::end() const{
+    return data + length;
+}
+
+size_t MappedFile::size() const{
+    return length;
+}
+
+std::string_view MappedFile::view() const{
+    return std::string_view(data, length);
+}
@@ -0,0 +1,32 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string_view>
+
+// Read-only memory mapping of a whole file, so it can be lexed or parsed in place without copying it into a \0-terminated
+// buffer. The contents are valid for the life of the object. Pass begin() and end(), or view(), to the bounded overloads
+class MappedFile{
+private:
+    const char *data = NULL;
+    size_t length = 0;
+    //Whether data points at a mapping that has to be unmapped. Empty files aren't mapped
+    bool mapped = false;
+    bool opened = false;
+
+public:
+    //Maps the file at path. Check ok() before using the contents
+    MappedFile(const char *path);
+    ~MappedFile();
+    //Disable copying, since the mapping is released by the destructor
+    MappedFile(MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&) = delete;
+    //Whether the file was opened and mapped
+    bool ok() const;
+    const char* begin() const;
+    const char* end() const;
+    size_t size() const;
+    std::string_view view() const;
+};
+
+#endif
@@ -4,6 +4,7 @@
 ParseTable::ParseTable(int x, int y, int initial){
     xmax = x;
     ymax = y;
+    this->initial = initial;
     data = new int[xmax*ymax];
     for (int i=0; i<xmax*ymax; i++){
         data[i] = initial;
@@ -14,6 +15,14 @@ int &ParseTable::operator()(int x, int y){
     return data[x*ymax + y];
 }
 
+void ParseTable::compress(){
+    packed.pack(xmax, ymax, [this](int x, int y){
+        return data[x*ymax + y];
+    }, std::vector<int>(xmax, initial));
+    delete[] data;
+    data = NULL;
+}
+
 ParseTable::~ParseTable(){
     delete[] data;
 }
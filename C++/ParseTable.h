@@ -1,12 +1,17 @@
 #ifndef PARSETABLE_H
 #define PARSETABLE_H
 
-//Class for 2d array. Used as parse table
+#include "CombTable.h"
+
+//Class for 2d array. Used as parse table. Once filled, it is compressed by row displacement with the initial value left out,
+//unless the table is too dense for that to save space
 class ParseTable{
 private:
     int *data;
     int xmax;
     int ymax;
+    int initial;
+    CombTable packed;
 
 public:
     //Creates table of set size with init values
@@ -14,8 +19,14 @@ public:
     //No copying or assigning
     ParseTable(ParseTable&) = delete;
     ParseTable& operator=(ParseTable&) = delete;
-    //Query with 2 dimensions
+    //Query with 2 dimensions. Only valid until the table is compressed
     int& operator()(int x, int y);
+    //Compresses the table and frees the full one
+    void compress();
+    //Query a compressed table. Kept in the header so the parse loop can inline it
+    int at(int x, int y) const{
+        return packed(x, y);
+    }
     ~ParseTable();
 };
 
@@ -0,0 +1,94 @@
+#include "PositionNFA.h"
+
+//Each NFA state with a char edge becomes a position. A state's follow positions are the positions in the epsilon closure of
+//where it leads: the starting state of the NFA for state 0, and the target of its char edge for a position
+regexp::PositionNFA::PositionNFA(const BaseRegexp &re){
+    const regexp::NFA &nfa = re.nfa;
+    std::vector<int> posNum(nfa.size(), -1);
+    //NFA state each state's closure starts from
+    std::vector<int> leadsTo;
+    leadsTo.push_back(re.starting);
+    transitionSet.push_back(0);
+    for (int i=0; i<nfa.size(); i++){
+        if (nfa.transitionSet[i] != 0){
+            posNum[i] = leadsTo.size();
+            leadsTo.push_back(nfa.edge[i]);
+            transitionSet.push_back(nfa.transitionSet[i]);
+        }
+    }
+    sets = nfa.sets;
+
+    std::vector<int> listids(nfa.size(), -1);
+    std::vector<int> states;
+    followStart.push_back(0);
+    for (int state=0; state<leadsTo.size(); state++){
+        states.clear();
+        states.push_back(leadsTo[state]);
+        re.closure(states, listids, state);
+        accepts.push_back(re.setAccept(states));
+        for (int nfaState : states){
+            if (posNum[nfaState] > -1)
+                follow.push_back(posNum[nfaState]);
+        }
+        followStart.push_back(follow.size());
+    }
+}
+
+size_t regexp::PositionNFA::size() const{
+    return accepts.size();
+}
+
+//Tracks the list of positions the simulation is in, same as the NFA simulation. There are no epsilon edges to follow, so
+//each char only looks at the follow positions of the current ones
+int regexp::PositionNFA::simulate(char* &str, MatchContext &context, const char* end, bool *hitEnd) const{
+    std::vector<int>& curStates = context.curStates;
+    std::vector<int>& nextStates = context.nextStates;
+    context.prepare(size());
+    long long *listids = context.listids.data();
+    long long base = context.generation;
+    const int *followStart = this->followStart.data();
+    const int *follow = this->follow.data();
+    const int *transitionSet = this->transitionSet.data();
+    const std::bitset<NumOfChars> *sets = this->sets.data();
+
+    if (hitEnd != NULL)
+        *hitEnd = false;
+    ptrdiff_t lastAcceptPos = 0;
+    int lastAcceptState = accepts[0];
+    curStates.push_back(0);
+    ptrdiff_t i;
+    for (i=0; !curStates.empty(); i++){
+        //The end of a bounded input is treated the same as \0. Neither has transitions, nor do chars outside the alphabet.
+        //States are still listed at the end, so more input could change the token
+        if (str+i == end && hitEnd != NULL)
+            *hitEnd = true;
+        unsigned char c = (str+i == end) ? 0 : str[i];
+        if (c == 0 || c >= NumOfChars)
+            break;
+        int accept = -1;
+        for (int state : curStates){
+            for (int j=followStart[state]; j<followStart[state+1]; j++){
+                int next = follow[j];
+                if (sets[transitionSet[next]][c] && listids[next] != base+i){
+                    listids[next] = base+i;
+                    nextStates.push_back(next);
+                    //Multiple accepts at the same char are resolved by the lowest accept value
+                    if (accepts[next] > -1 && (accept == -1 || accepts[next] < accept))
+                        accept = accepts[next];
+                }
+            }
+        }
+        if (accept > -1){
+            lastAcceptPos = i+1;
+            lastAcceptState = accept;
+        }
+        curStates.swap(nextStates);
+        nextStates.clear();
+    }
+
+    //Leave the context empty, with IDs past every one used here
+    curStates.clear();
+    context.generation = base+i+1;
+    str += lastAcceptPos;
+    return lastAcceptState;
+}
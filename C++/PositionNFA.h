@@ -0,0 +1,35 @@
+#ifndef POSITIONNFA_H
+#define POSITIONNFA_H
+
+#include "Regexp.h"
+#include <vector>
+
+namespace regexp{
+    // Epsilon-free position automaton (Glushkov automaton) of a regexp. State 0 is the starting state, and every other state
+    // is a position, which is one char set occurrence of the regexp. Every transition into a position is taken on that
+    // position's chars, so a state only needs its list of follow positions.
+    // Made from the Thompson NFA by removing epsilon edges, so it has one state per NFA state with a char edge
+    class PositionNFA{
+    private:
+        friend class BitNFA;
+        // Follow positions of each state, stored one after another. The ones of state s are follow[followStart[s]] up
+        // to follow[followStart[s+1]]
+        std::vector<int> followStart;
+        std::vector<int> follow;
+        // Index of each state's char set in sets. The starting state uses the empty set 0
+        std::vector<int> transitionSet;
+        std::vector<std::bitset<NumOfChars>> sets;
+        // Accept value of each state, which is what the NFA's isAccepting() returns for the state's epsilon closure.
+        // -1 means no accept
+        std::vector<int> accepts;
+
+    public:
+        // Builds the position automaton from the NFA of a regexp
+        PositionNFA(const BaseRegexp &re);
+        size_t size() const;
+        // Runs the automaton on a string input, obeying maximal munch. Same contract as BaseRegexp::simulate
+        int simulate(char* &str, MatchContext &context, const char* end = NULL, bool *hitEnd = NULL) const;
+    };
+}
+
+#endif
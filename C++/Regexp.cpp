@@ -1,4 +1,14 @@
 #include "Regexp.h"
+#include "DFA.h"
+#include "LazyDFA.h"
+#include "PositionNFA.h"
+#include "BitNFA.h"
+#include "JitDFA.h"
+#include <algorithm>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 //Converts position of syntax error into the error string 
 RegexSyntaxError::RegexSyntaxError(int pos){
@@ -44,14 +54,7 @@ void BaseRegexp::RegexpBuilder::updateFragment(std::bitset<NumOfChars>& transiti
 
 //Pushes a new state onto the NFA and returns its index
 int BaseRegexp::RegexpBuilder::push(){
-    int statenum = rePtr->nfa.size();
-    rePtr->nfa.push_back(new regexp::State);
-    //Sets default values of new state
-    rePtr->nfa[statenum]->transitions = std::bitset<NumOfChars>();
-    rePtr->nfa[statenum]->edge = -2; //The char edge will always be dangling. It will be invalidated if the transition bitset is 0
-    rePtr->nfa[statenum]->epsilon1 = -1; //Epsilon edges default to -1 and will be turned on manually
-    rePtr->nfa[statenum]->epsilon2 = -1;
-    return statenum; 
+    return rePtr->nfa.push();
 }
 
 //Takes the start and end of 2 regexp fragments and alternate them together into a new fragment: a | b => a|b
@@ -60,14 +63,14 @@ int BaseRegexp::RegexpBuilder::push(){
 void BaseRegexp::RegexpBuilder::alternate(int& startL, int& endL, int startR, int endR){
     //Push the new start (root) state and links its epsilon edges to the start states
     int root = push();
-    rePtr->nfa[root]->epsilon1 = startL;
-    rePtr->nfa[root]->epsilon2 = startR;
+    rePtr->nfa.epsilon1[root] = startL;
+    rePtr->nfa.epsilon2[root] = startR;
     //Push the new end (closure) state and concatenate the two end states to it
     int closure = push();
     concatenate(endL, closure);
     concatenate(endR, closure);
     //Closure will have a dangling epsilon so it can be linked to whatever comes next
-    rePtr->nfa[closure]->epsilon1 = -2;
+    rePtr->nfa.epsilon1[closure] = -2;
     //Update reference variables
     startL = root;
     endL = closure;
@@ -76,14 +79,14 @@ void BaseRegexp::RegexpBuilder::alternate(int& startL, int& endL, int startR, in
 //Updates all dangling edges of the left state with the right state, which concatentates the two
 //Given a-> and b, perform a -> b
 void BaseRegexp::RegexpBuilder::concatenate(int left, int right){
-    regexp::State* lptr = rePtr->nfa[left];
+    regexp::NFA& nfa = rePtr->nfa;
     //If the edges are dangling (-2), update with right
-    if (lptr->edge == -2)
-        lptr->edge = right;
-    if (lptr->epsilon1 == -2)
-        lptr->epsilon1 = right;
-    if (lptr->epsilon2 == -2)
-        lptr->epsilon2 = right;
+    if (nfa.edge[left] == -2)
+        nfa.edge[left] = right;
+    if (nfa.epsilon1[left] == -2)
+        nfa.epsilon1[left] = right;
+    if (nfa.epsilon2[left] == -2)
+        nfa.epsilon2[left] = right;
 }
 
 //Updates a regexp fragment with the ? unary operator
@@ -94,12 +97,12 @@ void BaseRegexp::RegexpBuilder::optional(int& start, int& end){
     int newStart = push();
     int newEnd = push();
     //Connect start state to the old start state and the new end state
-    rePtr->nfa[newStart]->epsilon2 = start;
-    rePtr->nfa[newStart]->epsilon1 = newEnd;
+    rePtr->nfa.epsilon2[newStart] = start;
+    rePtr->nfa.epsilon1[newStart] = newEnd;
     //Concatenate old end to new end
     concatenate(end, newEnd);
     //New end will have dangling epsilon so it can be connected to what comes next
-    rePtr->nfa[newEnd]->epsilon1 = -2;
+    rePtr->nfa.epsilon1[newEnd] = -2;
     //Update reference variables
     start = newStart;
     end = newEnd;
@@ -112,8 +115,8 @@ void BaseRegexp::RegexpBuilder::repeating(int& start, int& end){
     //Push new end state
     int newEnd = push();
     //Connect one epsilon edge to the old starting state and the other will dangle so it can be connected later
-    rePtr->nfa[newEnd]->epsilon2 = start;
-    rePtr->nfa[newEnd]->epsilon1 = -2;
+    rePtr->nfa.epsilon2[newEnd] = start;
+    rePtr->nfa.epsilon1[newEnd] = -2;
     //Concatenate the old end to the new end
     concatenate(end, newEnd);
     end = newEnd;
@@ -147,7 +150,7 @@ void BaseRegexp::RegexpBuilder::parseConcat(int& startL, int& endL){
     if (!notEnd() || regexp[pos]=='|' || regexp[pos]==')'){
         //The fragment will only consist of one new state with only a dangling epsilon edge
         startL = endL = push();
-        rePtr->nfa[startL]->epsilon1 = -2;
+        rePtr->nfa.epsilon1[startL] = -2;
         return;
     }
     //Parses a unary fragment
@@ -229,7 +232,7 @@ char BaseRegexp::RegexpBuilder::parseC(){
 int BaseRegexp::RegexpBuilder::parseChar(){
     //Push a new state representing the char and prepare to update its transitions
     int start = push();
-    std::bitset<NumOfChars>& transition = rePtr->nfa[start]->transitions;
+    std::bitset<NumOfChars> transition;
     //If \ is encountered, the next character will be parsed with escaped semantics
     if (next('\\')){
         parseSpecial(transition);
@@ -244,13 +247,14 @@ int BaseRegexp::RegexpBuilder::parseChar(){
         char c = parseC();
         transition[c] = 1;
     }
+    rePtr->nfa.setTransitions(start, transition);
     return start;
 }
 
 //Parse a single-state set and returns state numbers
 int BaseRegexp::RegexpBuilder::parseSet(){
     int start = push();
-    std::bitset<NumOfChars>& transition = rePtr->nfa[start]->transitions;
+    std::bitset<NumOfChars> transition;
     //Set the inverse flag according to the optional ^ 
     bool inverse = false;
     if (next('^'))
@@ -264,6 +268,7 @@ int BaseRegexp::RegexpBuilder::parseSet(){
     if (inverse){
         transition.flip();
     }
+    rePtr->nfa.setTransitions(start, transition);
     return start;
 }
 
@@ -333,72 +338,587 @@ void BaseRegexp::RegexpBuilder::build(char* re, BaseRegexp *rp, int &start, int
     concatenate(end, accept);
 }
 
+//Resets the list IDs only when they don't fit the automaton or are about to overflow. The state lists can hold every state
+//plus the starting state, which is added without a list ID. Buffers only grow, so a context can go back and forth between
+//automata of different sizes, like the NFA and position automaton of one regexp
+void regexp::MatchContext::prepare(size_t states){
+    if (listids.size() < states || generation > LLONG_MAX/2){
+        listids.assign(states, -1);
+        curStarts.assign(states, -1);
+        nextStarts.assign(states, -1);
+        generation = 0;
+        curStates.reserve(states+1);
+        nextStates.reserve(states+1);
+    }
+}
+
+//Starts with only the empty transition bitset in the pool
+regexp::NFA::NFA(){
+    sets.push_back(std::bitset<NumOfChars>());
+}
+
+size_t regexp::NFA::size() const{
+    return edge.size();
+}
+
+int regexp::NFA::push(){
+    int statenum = edge.size();
+    edge.push_back(-2); //The char edge will always be dangling. It will be invalidated if the transition bitset is 0
+    epsilon1.push_back(-1); //Epsilon edges default to -1 and will be turned on manually
+    epsilon2.push_back(-1);
+    transitionSet.push_back(0);
+    return statenum;
+}
+
+void regexp::NFA::pop_back(){
+    edge.pop_back();
+    epsilon1.pop_back();
+    epsilon2.pop_back();
+    transitionSet.pop_back();
+}
+
+const std::bitset<NumOfChars>& regexp::NFA::transitions(int state) const{
+    return sets[transitionSet[state]];
+}
+
+//Points the state at an equal bitset already in the pool, or adds the bitset to the pool
+void regexp::NFA::setTransitions(int state, const std::bitset<NumOfChars>& transitions){
+    for (int i=0; i<sets.size(); i++){
+        if (sets[i] == transitions){
+            transitionSet[state] = i;
+            return;
+        }
+    }
+    transitionSet[state] = sets.size();
+    sets.push_back(transitions);
+}
+
+//Epsilon edges are queued before the char edge, so a state is followed by the states of its closure. States that can't be
+//reached from the start keep their relative order after the reachable ones
+void regexp::NFA::layout(int &starting, std::vector<int>& newNum){
+    int length = size();
+    newNum.assign(length, -1);
+    std::vector<int> order;
+    order.reserve(length);
+    newNum[starting] = 0;
+    order.push_back(starting);
+    for (int i=0; i<order.size(); i++){
+        int state = order[i];
+        int edges[3] = {epsilon1[state], epsilon2[state], (transitionSet[state] != 0) ? edge[state] : -1};
+        for (int next : edges){
+            if (next >= 0 && newNum[next] == -1){
+                newNum[next] = order.size();
+                order.push_back(next);
+            }
+        }
+    }
+    for (int state=0; state<length; state++){
+        if (newNum[state] == -1){
+            newNum[state] = order.size();
+            order.push_back(state);
+        }
+    }
+    //Edges are renumbered as the arrays are rebuilt in the new order
+    auto renumber = [&](int target){
+        return (target >= 0) ? newNum[target] : target;
+    };
+    std::vector<int> newEdge(length), newEpsilon1(length), newEpsilon2(length), newTransitionSet(length);
+    for (int i=0; i<length; i++){
+        int state = order[i];
+        newEdge[i] = (transitionSet[state] != 0) ? renumber(edge[state]) : -1;
+        newEpsilon1[i] = renumber(epsilon1[state]);
+        newEpsilon2[i] = renumber(epsilon2[state]);
+        newTransitionSet[i] = transitionSet[state];
+    }
+    edge.swap(newEdge);
+    epsilon1.swap(newEpsilon1);
+    epsilon2.swap(newEpsilon2);
+    transitionSet.swap(newTransitionSet);
+    starting = 0;
+}
+
+//Finds literals that every match of the built regexp contains, so searches can skip input that can't match.
+//Candidates start at the start, or at a single-char state that the accept state can't be reached without, and follow the
+//NFA from there for as long as there is only one char it can take. The factor is the longest candidate. The seek literal
+//is the longest one whose lead, the most chars a match can have before it, is bounded. The prefix has a lead of 0
+void BaseRegexp::RegexpBuilder::findLiterals(int start, int accept, std::string &seek, int &lead, std::string &factor){
+    std::vector<int> listids(rePtr->nfa.size(), -1);
+    int id = 0;
+    std::vector<int> states;
+    states.push_back(start);
+    rePtr->closure(states, listids, id++);
+    seek.clear();
+    followLiteral(states, accept, seek, listids, id);
+    lead = 0;
+
+    factor = seek;
+    for (int i=0; i<rePtr->nfa.size(); i++){
+        if (rePtr->nfa.transitions(i).count() != 1 || reachableWithout(start, accept, i))
+            continue;
+        std::string literal;
+        states.clear();
+        states.push_back(i);
+        followLiteral(states, accept, literal, listids, id);
+        if (literal.size() > factor.size())
+            factor = literal;
+        if (literal.size() > seek.size()){
+            int distance = leadTo(start, i);
+            if (distance >= 0){
+                seek = literal;
+                lead = distance;
+            }
+        }
+    }
+}
+
+//Returns the one char that every state in a closed set continues with. Returns 0 if there are different chars,
+//a set of chars, or the accept state, since then the literal ends
+char BaseRegexp::RegexpBuilder::singleChar(std::vector<int>& states, int accept){
+    char c = 0;
+    for (int state : states){
+        const std::bitset<NumOfChars>& transition = rePtr->nfa.transitions(state);
+        if (state == accept)
+            return 0;
+        if (transition.none())
+            continue;
+        if (transition.count() != 1)
+            return 0;
+        for (int i=1; i<NumOfChars; i++){
+            if (transition[i]){
+                if (c != 0 && c != i)
+                    return 0;
+                c = i;
+            }
+        }
+    }
+    return c;
+}
+
+//Extends a literal for as long as the closed set of states can only continue with one char. The set is left at the end
+void BaseRegexp::RegexpBuilder::followLiteral(std::vector<int>& states, int accept, std::string &literal,
+    std::vector<int>& listids, int &id){
+    char c;
+    //Limit guards against cycles that never reach the accept state
+    while ((c = singleChar(states, accept)) && literal.size() < 256){
+        literal.push_back(c);
+        std::vector<int> nextStates;
+        for (int state : states){
+            if (rePtr->nfa.transitions(state)[c])
+                nextStates.push_back(rePtr->nfa.edge[state]);
+        }
+        states.swap(nextStates);
+        rePtr->closure(states, listids, id++);
+    }
+}
+
+//Checks whether the accept state can be reached from the start without passing thru the avoided state
+bool BaseRegexp::RegexpBuilder::reachableWithout(int start, int accept, int avoid){
+    std::vector<char> seen(rePtr->nfa.size(), 0);
+    std::vector<int> stack;
+    stack.push_back(start);
+    seen[start] = 1;
+    seen[avoid] = 1;
+    while (!stack.empty()){
+        int state = stack.back();
+        stack.pop_back();
+        if (state == accept)
+            return true;
+        regexp::NFA& nfa = rePtr->nfa;
+        int edges[3] = {nfa.epsilon1[state], nfa.epsilon2[state], nfa.transitions(state).any() ? nfa.edge[state] : -1};
+        for (int next : edges){
+            if (next >= 0 && !seen[next]){
+                seen[next] = 1;
+                stack.push_back(next);
+            }
+        }
+    }
+    return false;
+}
+
+//Returns the most chars a path from the start can take before it first reaches the target, or -1 if that is more than
+//MaxLead, as it is when a loop can be taken on the way. Lengths only ever grow, so each state is revisited at most
+//MaxLead times
+int BaseRegexp::RegexpBuilder::leadTo(int start, int target){
+    regexp::NFA& nfa = rePtr->nfa;
+    std::vector<int> distance(nfa.size(), -1);
+    std::vector<int> stack;
+    distance[start] = 0;
+    stack.push_back(start);
+    while (!stack.empty()){
+        int state = stack.back();
+        stack.pop_back();
+        if (state == target)
+            continue;
+        int edges[3] = {nfa.epsilon1[state], nfa.epsilon2[state], nfa.transitions(state).any() ? nfa.edge[state] : -1};
+        for (int k=0; k<3; k++){
+            int next = edges[k];
+            int length = distance[state] + (k == 2);
+            if (next < 0 || length <= distance[next])
+                continue;
+            if (length > regexp::MaxLead)
+                return -1;
+            distance[next] = length;
+            stack.push_back(next);
+        }
+    }
+    return distance[target];
+}
+
+//Checks candidate positions 16 at a time with SSE2 by comparing the first and last chars of the literal, then
+//confirms each candidate. Falls back to memchr on the first char for what's left, or without SSE2
+const char* regexp::findLiteral(const char* begin, const char* end, const std::string &literal){
+    int n = literal.size();
+    if (n == 0)
+        return begin;
+    if (end - begin < n)
+        return NULL;
+    //Last position the literal could start at
+    const char* last = end - n;
+    const char* p = begin;
+#ifdef __SSE2__
+    __m128i first = _mm_set1_epi8(literal[0]);
+    __m128i final = _mm_set1_epi8(literal[n-1]);
+    for (; p+15 <= last; p += 16){
+        __m128i firstBlock = _mm_loadu_si128((const __m128i*)p);
+        __m128i finalBlock = _mm_loadu_si128((const __m128i*)(p + n-1));
+        int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firstBlock, first), _mm_cmpeq_epi8(finalBlock, final)));
+        for (int i=0; mask != 0; i++, mask >>= 1){
+            if ((mask & 1) && memcmp(p+i, literal.data(), n) == 0)
+                return p+i;
+        }
+    }
+#endif
+    while (p <= last){
+        p = (const char*)memchr(p, literal[0], last-p+1);
+        if (p == NULL)
+            return NULL;
+        if (memcmp(p, literal.data(), n) == 0)
+            return p;
+        p++;
+    }
+    return NULL;
+}
+
 //Helper function for the simulation that adds a non-repeating state to a list of states
-void BaseRegexp::addState(int state, std::vector<int>& curStates, int *listids, int id){
+void BaseRegexp::addState(int state, std::vector<int>& curStates, long long *listids, long long id) const{
     if (listids[state] != id){
         listids[state] = id;
         curStates.push_back(state);
     }
 }
 
+//Expands a list of states with every state reachable by epsilon edges, using listids to skip repeats.
+//The list is sorted afterwards so that equal state sets compare equal
+void BaseRegexp::closure(std::vector<int>& states, std::vector<int>& listids, int id) const{
+    for (int i=0; i<states.size(); i++)
+        listids[states[i]] = id;
+    //The list grows while it is being looped through, same as the simulation
+    for (int i=0; i<states.size(); i++){
+        int epsilon1 = nfa.epsilon1[states[i]];
+        int epsilon2 = nfa.epsilon2[states[i]];
+        if (epsilon1 >= 0 && listids[epsilon1] != id){
+            listids[epsilon1] = id;
+            states.push_back(epsilon1);
+        }
+        if (epsilon2 >= 0 && listids[epsilon2] != id){
+            listids[epsilon2] = id;
+            states.push_back(epsilon2);
+        }
+    }
+    std::sort(states.begin(), states.end());
+}
+
+//Returns the lowest accept value among a set of states, so earlier regexps of a lexer win ties. -1 if none accept
+int BaseRegexp::setAccept(std::vector<int>& states) const{
+    int accept = -1;
+    for (int state : states){
+        int stateAccept = isAccepting(state);
+        if (stateAccept > -1 && (accept == -1 || stateAccept < accept))
+            accept = stateAccept;
+    }
+    return accept;
+}
+
+//Splits the alphabet into equivalence classes, refining them once per NFA transition bitset. Two chars stay in the same
+//class only if every bitset contains both of them or neither. \0 always gets class 0 to itself, since it ends the input.
+//Fills the char-to-class map and returns the number of classes
+int BaseRegexp::charClasses(unsigned char *classMap) const{
+    classMap[0] = 0;
+    for (int c=1; c<NumOfChars; c++)
+        classMap[c] = 1;
+    int classCount = 2;
+    //Maps (old class, membership in bitset) to the new class
+    std::vector<int> split;
+    //Every state with the same bitset refines the classes the same way, so each pooled bitset is used once
+    for (int i=1; i<nfa.sets.size(); i++){
+        const std::bitset<NumOfChars>& transition = nfa.sets[i];
+        if (transition.none())
+            continue;
+        split.assign(classCount*2, -1);
+        int newCount = 0;
+        for (int c=0; c<NumOfChars; c++){
+            int key = classMap[c]*2 + transition[c];
+            if (split[key] == -1)
+                split[key] = newCount++;
+            classMap[c] = split[key];
+        }
+        classCount = newCount;
+    }
+    return classCount;
+}
+
 //Simulates the state machine for a string input, obeying maximal munch
 //Returns the accepting state if successful, otherwise return -1. Advances the input pointer to the end of the regexp simulation
+//The input ends at end, or at the first \0 if end is NULL
+int BaseRegexp::simulate(char* &str, regexp::MatchContext &context, const char* end, bool *hitEnd) const{
+    if (bits != NULL)
+        return bits->simulate(str, end, hitEnd);
+    //Compiled code doesn't report where its scan stopped, so the table it was compiled from runs instead
+    if (jit != NULL && hitEnd == NULL)
+        return jit->simulate(str, end);
+    if (engine == Engine::DFA || engine == Engine::JIT)
+        return dfa->simulate(str, end, NULL, hitEnd);
+    if (engine == Engine::LAZYDFA)
+        return lazy->simulate(*this, str, context, end, hitEnd);
+    if (engine == Engine::POSITION)
+        return positions->simulate(str, context, end, hitEnd);
+    return simulateNFA(str, context, end, hitEnd);
+}
+//Same as above, using the regexp's own scratch space
 int BaseRegexp::simulate(char* &str){
-    std::vector<int> curStates;
-    std::vector<int> nextStates;
+    return simulate(str, scratch);
+}
+
+//Renumbers the NFA so simulations touch it in order. Only called once the NFA is complete, before any automaton is built from it
+void BaseRegexp::layout(std::vector<int>& newNum){
+    nfa.layout(starting, newNum);
+}
+
+//Builds the automaton for the chosen engine. The NFA engine only keeps the position automaton when it is small enough
+//to simulate bit-parallel
+void BaseRegexp::compile(Engine::Engine engine){
+    this->engine = engine;
+    if (engine == Engine::DFA)
+        dfa = new regexp::DFA(*this);
+    else if (engine == Engine::JIT){
+        dfa = new regexp::DFA(*this);
+        jit = new regexp::JitDFA(*dfa);
+        if (!jit->ok()){
+            delete jit;
+            jit = NULL;
+        }
+    }
+    else if (engine == Engine::LAZYDFA)
+        lazy = new regexp::LazyDFA(*this);
+    else{
+        positions = new regexp::PositionNFA(*this);
+        if (positions->size() <= regexp::BitNFA::MaxStates)
+            bits = new regexp::BitNFA(*positions, *this);
+        if (engine == Engine::NFA){
+            delete positions;
+            positions = NULL;
+        }
+    }
+}
+
+//Counters of the lazy DFA cache. All zero for other engines
+regexp::CacheStats BaseRegexp::cacheStats(){
+    if (lazy == NULL)
+        return regexp::CacheStats();
+    return lazy->stats();
+}
+
+//Sets the max number of states the lazy DFA cache holds before flushing. Does nothing for other engines
+void BaseRegexp::cacheLimit(size_t states){
+    if (lazy != NULL)
+        lazy->setLimit(states);
+}
+
+//Runs the NFA directly by tracking the list of every state the simulation is in
+int BaseRegexp::simulateNFA(char* &str, regexp::MatchContext &context, const char* end, bool *hitEnd) const{
+    std::vector<int>& curStates = context.curStates;
+    std::vector<int>& nextStates = context.nextStates;
     //Position in string the last time the simulation reached an accept state
-    int lastAcceptPos = 0;
+    ptrdiff_t lastAcceptPos = 0;
     //Number of the last accept state reached
     int lastAcceptState = -1;
     //Inintializes the list of current states with starting state of NFA
     curStates.push_back(starting);
+    if (hitEnd != NULL)
+        *hitEnd = false;
 
     //list ID array assigns a list ID to each state. 
     //ID is updated with the iteration number of the simulation each time the state is added,
-    //and can be referenced later to avoid duplicates
-    int *listids = new int[nfa.size()];
-    for (int i=0; i<nfa.size(); i++)
-        listids[i] = -1;
+    //and can be referenced later to avoid duplicates. Iteration numbers are offset by the context's generation
+    context.prepare(nfa.size());
+    long long *listids = context.listids.data();
+    long long base = context.generation;
+    const int *edge = nfa.edge.data();
+    const int *epsilon1 = nfa.epsilon1.data();
+    const int *epsilon2 = nfa.epsilon2.data();
+    const int *transitionSet = nfa.transitionSet.data();
+    const std::bitset<NumOfChars> *sets = nfa.sets.data();
 
     //Loop thru every char in the input until no more states can be processed and simulation completely stops
-    for (int i=0; !curStates.empty(); i++){
-        char c = str[i];
+    ptrdiff_t i;
+    for (i=0; !curStates.empty(); i++){
+        //The end of a bounded input is treated the same as \0. States are still listed there, so more input could change the token
+        if (str+i == end && hitEnd != NULL)
+            *hitEnd = true;
+        char c = (str+i == end) ? 0 : str[i];
         //Loop thru each current state
         for (int j=0; j<curStates.size(); j++){
             int accept = isAccepting(curStates[j]);
             //If the state is the first accepting state at this char, then update the acceptance variables
             //Allow update regardless of i if parse still unsuccessful, to allow update for empty match
-            if (accept > -1 && (i > lastAcceptPos || lastAcceptState == -1)){
+            //Multiple accepts at the same char are resolved by the lowest accept value
+            if (accept > -1 && (i > lastAcceptPos || lastAcceptState == -1 || accept < lastAcceptState)){
                 lastAcceptPos = i;
                 lastAcceptState = accept;
             }
 
-            regexp::State *stateptr = nfa[curStates[j]];
+            int state = curStates[j];
             //Valid epsilon edges are added to the current list to be processed in the same iteration
-            if (stateptr->epsilon1 >= 0)
-                addState(stateptr->epsilon1, curStates, listids, i);
-            if (stateptr->epsilon2 >= 0)
-                addState(stateptr->epsilon2, curStates, listids, i);
+            if (epsilon1[state] >= 0)
+                addState(epsilon1[state], curStates, listids, base+i);
+            if (epsilon2[state] >= 0)
+                addState(epsilon2[state], curStates, listids, base+i);
             //Valid char edges are added to the next list to be processed the next iteration
-            if (stateptr->transitions[c])
-                addState(stateptr->edge, nextStates, listids, i+1);
+            if (sets[transitionSet[state]][c])
+                addState(edge[state], nextStates, listids, base+i+1);
         }
         curStates.swap(nextStates);
         nextStates.clear();
         //Stop the algorithm if the end of input is reached
-        if (str[i] == 0) break;
+        if (c == 0) break;
     }
 
-    delete[] listids;
+    //Leave the context empty, with IDs past every one used here
+    curStates.clear();
+    nextStates.clear();
+    context.generation = base+i+2;
     //Set input pointer to the location where the parse stopped
     str += lastAcceptPos;
     return lastAcceptState;
 }
 
-BaseRegexp::~BaseRegexp(){
-    for (int i=0; i<nfa.size(); i++){
-        delete[] nfa[i];
+//Adds a non-repeating state to a list of states along with where its match started. A state already listed by a match
+//that started later is taken over by the earlier one. It is listed again when relist is set, so that the states it
+//already led to in the current list get the earlier start too. Starts only decrease, so this ends
+void BaseRegexp::addThread(int state, ptrdiff_t start, std::vector<int>& states, ptrdiff_t *starts, long long *listids,
+    long long id, bool relist) const{
+    if (listids[state] != id){
+        listids[state] = id;
+        states.push_back(state);
+        starts[state] = start;
+    }
+    else if (start < starts[state]){
+        starts[state] = start;
+        if (relist)
+            states.push_back(state);
+    }
+}
+
+//Runs the NFA once over the input while starting a new match at every position. Each listed state remembers where its match
+//started. When two matches reach the same state the leftmost one keeps it, whichever got there first.
+//Finds the leftmost match, and the longest one at that start. Sets the input pointer to the start of the match and
+//length to its # of chars. Returns the accept value, or -1 if there is no match
+int BaseRegexp::searchNFA(char* &str, ptrdiff_t &length, regexp::MatchContext &context, const char* end,
+    const std::string &literal, int lead) const{
+    std::vector<int>& curStates = context.curStates;
+    std::vector<int>& nextStates = context.nextStates;
+    context.prepare(nfa.size());
+    long long *listids = context.listids.data();
+    long long base = context.generation;
+    const int *edge = nfa.edge.data();
+    const int *epsilon1 = nfa.epsilon1.data();
+    const int *epsilon2 = nfa.epsilon2.data();
+    const int *transitionSet = nfa.transitionSet.data();
+    const std::bitset<NumOfChars> *sets = nfa.sets.data();
+    //Start, end and accept value of the best match so far
+    ptrdiff_t bestStart = -1;
+    ptrdiff_t bestEnd = -1;
+    int bestAccept = -1;
+
+    //Seeking needs the end of input, so it is measured once
+    const char* limit = end;
+    if (!literal.empty() && limit == NULL)
+        limit = str + strlen(str);
+    //Where the literal next occurs. It is only looked for again once the search has passed it
+    ptrdiff_t next = -1;
+
+    ptrdiff_t i;
+    for (i=0; ; i++){
+        //With no match in progress, the next match contains the next occurrence of the literal, so it starts at most
+        //lead chars before it
+        if (!literal.empty() && curStates.empty() && bestStart == -1){
+            if (next < i){
+                const char* found = regexp::findLiteral(str+i, limit, literal);
+                if (found == NULL)
+                    break;
+                next = found - str;
+            }
+            if (next - lead > i)
+                i = next - lead;
+        }
+        //Bounded input only ends at end. A \0 before it is a char that no state takes, so it ends matches but not the search
+        bool last = (end == NULL) ? str[i] == 0 : str+i == end;
+        char c = last ? 0 : str[i];
+        ptrdiff_t *curStarts = context.curStarts.data();
+        ptrdiff_t *nextStarts = context.nextStarts.data();
+        //Matches only start before the end of input, and stop starting once one has been found
+        bool started = (bestStart > -1 || last);
+        for (int j=0; j<curStates.size() || !started; j++){
+            //The starting state is added after the closures of the earlier matches, so it never takes their states
+            if (j == curStates.size()){
+                started = true;
+                addThread(starting, i, curStates, curStarts, listids, base+i, true);
+                if (j == curStates.size())
+                    break;
+            }
+            int state = curStates[j];
+            ptrdiff_t start = curStarts[state];
+            //Matches starting after the best match can't beat it
+            if (bestStart > -1 && start > bestStart)
+                continue;
+            int accept = isAccepting(state);
+            if (accept > -1 && (bestStart == -1 || start < bestStart ||
+                (start == bestStart && (i > bestEnd || (i == bestEnd && accept < bestAccept))))){
+                bestStart = start;
+                bestEnd = i;
+                bestAccept = accept;
+            }
+
+            //States in the next list haven't been processed yet, so lowering their start is enough
+            if (epsilon1[state] >= 0)
+                addThread(epsilon1[state], start, curStates, curStarts, listids, base+i, true);
+            if (epsilon2[state] >= 0)
+                addThread(epsilon2[state], start, curStates, curStarts, listids, base+i, true);
+            if (c != 0 && sets[transitionSet[state]][c])
+                addThread(edge[state], start, nextStates, nextStarts, listids, base+i+1, false);
+        }
+        curStates.swap(nextStates);
+        context.curStarts.swap(context.nextStarts);
+        nextStates.clear();
+        //Stop at the end of input, or once a match has been found and every other match has died
+        if (last || (curStates.empty() && bestStart > -1)) break;
     }
+
+    curStates.clear();
+    context.generation = base+i+2;
+    if (bestStart > -1){
+        str += bestStart;
+        length = bestEnd - bestStart;
+    }
+    return bestAccept;
+}
+
+BaseRegexp::~BaseRegexp(){
+    delete jit;
+    delete dfa;
+    delete lazy;
+    delete positions;
+    delete bits;
     starting = -1;
 }
 
@@ -406,19 +926,19 @@ BaseRegexp::~BaseRegexp(){
 std::ostream& operator<<(std::ostream& os, const BaseRegexp& regexp){
     for (int i=0; i<regexp.nfa.size(); i++){
         os << i << " -> ";
-        regexp::State *stateptr = regexp.nfa[i];
-        if (stateptr->transitions.any()){
-            os << stateptr->edge << " : {";
+        const std::bitset<NumOfChars>& transitions = regexp.nfa.transitions(i);
+        if (transitions.any()){
+            os << regexp.nfa.edge[i] << " : {";
             for (int j=0; j<NumOfChars; j++){
-                if (stateptr->transitions[j] == 1)
+                if (transitions[j] == 1)
                     os << (char)j;
             }
             os << "} ";
         }
-        if (stateptr->epsilon1 >= 0)
-            os << "epsilon:" << stateptr->epsilon1 << ' ';
-        if (stateptr->epsilon2 >= 0)
-            os << "epsilon:" << stateptr->epsilon2 << ' ';
+        if (regexp.nfa.epsilon1[i] >= 0)
+            os << "epsilon:" << regexp.nfa.epsilon1[i] << ' ';
+        if (regexp.nfa.epsilon2[i] >= 0)
+            os << "epsilon:" << regexp.nfa.epsilon2[i] << ' ';
         os << '\n';
     }
     os << "Starting: " << regexp.starting << '\n';
@@ -428,14 +948,14 @@ std::ostream& operator<<(std::ostream& os, const BaseRegexp& regexp){
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 //Regexp class has a single accepting state, so any input state must match it to be accepting
-int Regexp::isAccepting(int state){
+int Regexp::isAccepting(int state) const{
     if (state == accepting)
         return accepting;
     return -1;
 }
 
 //Matches Regexp to the beginning of input and returns the # of chars that were matched. Returns -1 if nothing was matched
-int Regexp::match(char* str){
+ptrdiff_t Regexp::match(char* str){
     char *end = str;
     int success = simulate(end);
     if (success < 0)
@@ -443,29 +963,116 @@ int Regexp::match(char* str){
     return end-str;
 }
 
-//Runs simulation thru each position of the input to look for matches and sets input ptr to start of match. Returns # of chars match, -1 if no match
-int Regexp::search(char* &str){
-    for (int i=0; str[i]!=0; i++){
-        char *end = str+i;
-        int success = simulate(end);
-        if (success >= 0){
-            str += i;
-            return end - str;
-        }
+//Searches the input for the leftmost match in a single pass and sets input ptr to start of match. Returns # of chars match, -1 if no match
+ptrdiff_t Regexp::search(char* &str){
+    return search(str, scratch);
+}
+//A factor longer than the seek literal only rejects input without it before running the NFA
+ptrdiff_t Regexp::search(char* &str, regexp::MatchContext &context, const char* end) const{
+    if (factor.size() > seek.size()){
+        const char* limit = (end == NULL) ? str + strlen(str) : end;
+        if (regexp::findLiteral(str, limit, factor) == NULL)
+            return -1;
     }
-    return -1;
+    ptrdiff_t length;
+    if (searchNFA(str, length, context, end, seek, lead) < 0)
+        return -1;
+    return length;
+}
+
+RegexpMatches Regexp::searchAll(char* str, const char* end) const{
+    return RegexpMatches(this, str, end);
+}
+
+//Bounded input is never written to, so it is only cast to the char* the simulations take
+ptrdiff_t Regexp::match(const char* begin, const char* end){
+    char *pos = (char*)begin;
+    if (simulate(pos, scratch, end) < 0)
+        return -1;
+    return pos-begin;
+}
+ptrdiff_t Regexp::match(std::string_view str){
+    //An empty view may have no data, and a NULL end would mean \0-terminated input
+    if (str.empty())
+        str = std::string_view("", 0);
+    return match(str.data(), str.data() + str.size());
+}
+
+ptrdiff_t Regexp::search(const char* &begin, const char* end){
+    char *pos = (char*)begin;
+    ptrdiff_t length = search(pos, scratch, end);
+    if (length >= 0)
+        begin = pos;
+    return length;
+}
+ptrdiff_t Regexp::search(std::string_view &str){
+    if (str.empty())
+        str = std::string_view("", 0);
+    const char *begin = str.data();
+    ptrdiff_t length = search(begin, str.data() + str.size());
+    if (length >= 0)
+        str.remove_prefix(begin - str.data());
+    return length;
+}
+
+RegexpMatches Regexp::searchAll(std::string_view str) const{
+    if (str.empty())
+        str = std::string_view("", 0);
+    return RegexpMatches(this, (char*)str.data(), str.data() + str.size());
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//The end of \0-terminated input is found up front so searches don't each measure the rest of the input
+RegexpMatches::RegexpMatches(const Regexp *re, char *str, const char *end){
+    this->re = re;
+    curpos = str;
+    this->end = (end == NULL) ? str + strlen(str) : end;
+}
+
+//Searches from the end of the previous match. An empty match moves the search forward by a char so it isn't found again
+bool RegexpMatches::next(){
+    if (curpos == NULL || curpos >= end){
+        curpos = NULL;
+        return false;
+    }
+    matchStart = curpos;
+    matchLength = re->search(matchStart, context, end);
+    if (matchLength < 0){
+        curpos = NULL;
+        return false;
+    }
+    curpos = matchStart + matchLength;
+    if (matchLength == 0)
+        curpos++;
+    return true;
+}
+
+char *RegexpMatches::start(){
+    return matchStart;
+}
+
+ptrdiff_t RegexpMatches::length(){
+    return matchLength;
 }
 
 //Constructor builds regexp once
-Regexp::Regexp(char* re){
+Regexp::Regexp(char* re, Engine::Engine engine){
     RegexpBuilder builder;
     builder.build(re, this, starting, accepting);
-
+    std::vector<int> newNum;
+    layout(newNum);
+    accepting = newNum[accepting];
+    builder.findLiterals(starting, accepting, seek, lead, factor);
+    compile(engine);
 }
 //Default constructor builds empty regexp
 Regexp::Regexp(){
     RegexpBuilder builder;
     builder.build("", this, starting, accepting);  
+    std::vector<int> newNum;
+    layout(newNum);
+    accepting = newNum[accepting];
 }
 
 //Regexp cout overload adds the accept state
@@ -6,25 +6,125 @@
 #include <bitset>
 #include <exception>
 #include <iostream>
+#include <climits>
+#include <cstddef>
+#include <string>
+#include <string_view>
 
 // Number of ASCII character possible. Regexp alphabet size.
 const int NumOfChars = 128;
 
 // Namespace containing definitions exclusive to the Regexp module
 namespace regexp{    
-    // Represents states of an NFA. Edge value of -1 means it doesn't exist; -2 means a dangling edge.
-    struct State{
-        // Bitset deciding the characters used as transition for the state. 0 is no 1 is yes.  
-        std::bitset<NumOfChars> transitions;
+    // NFA stored as parallel arrays indexed by state number, so simulations walk contiguous memory instead of chasing
+    // a pointer per state. Edge value of -1 means it doesn't exist; -2 means a dangling edge.
+    struct NFA{
         // The destination of the edge that uses characters as transition. Defaults to -2.
-        int edge;
+        std::vector<int> edge;
         // Epsilon edge dedicated to concatenations
-        int epsilon1;
+        std::vector<int> epsilon1;
         // Epsilon edge dedicated to unary operations
-        int epsilon2;
+        std::vector<int> epsilon2;
+        // Index of each state's transition bitset in sets
+        std::vector<int> transitionSet;
+        // Bitsets deciding the characters used as transition. 0 is no 1 is yes. Equal bitsets are stored once, and set 0
+        // is the empty one used by states without a char edge
+        std::vector<std::bitset<NumOfChars>> sets;
+
+        NFA();
+        size_t size() const;
+        // Pushes a new state with a dangling char edge, no epsilon edges and no transitions. Returns its number
+        int push();
+        void pop_back();
+        const std::bitset<NumOfChars>& transitions(int state) const;
+        void setTransitions(int state, const std::bitset<NumOfChars>& transitions);
+        // Renumbers the states in BFS order from the starting state, so the states of an epsilon closure end up next
+        // to each other. Char edges of states without transitions are removed. Fills the old-to-new state numbers
+        void layout(int &starting, std::vector<int>& newNum);
+    };
+    class DFA;
+    class LazyDFA;
+    class PositionNFA;
+    class BitNFA;
+    class JitDFA;
+
+    // Scratch space for simulating the NFA. Owned by the caller rather than the regexp, so that one compiled regexp can be
+    // simulated by many threads at once. The buffers grow to the size of the NFA once and are reused after that
+    struct MatchContext{
+        // List ID of each NFA state, used to skip repeated states. IDs count input positions, so they are 64-bit
+        std::vector<long long> listids;
+        // Lists of states the simulation is currently in and will be in after the next char
+        std::vector<int> curStates;
+        std::vector<int> nextStates;
+        // Where the match of each listed state started, indexed by state. Only used by searches
+        std::vector<ptrdiff_t> curStarts;
+        std::vector<ptrdiff_t> nextStarts;
+        // First list ID not yet used. IDs keep increasing across simulations so listids never needs clearing
+        long long generation = 0;
+        // Sizes the buffers for an automaton. Only allocates when it is bigger than any before or the IDs run out
+        void prepare(size_t states);
+    };
+
+    // Memo of (DFA state, input position) pairs that are known to never reach another accept, as in Reps' maximal munch
+    // algorithm. A simulation reaching a failed pair can stop right away, so lexing a whole input takes linear time.
+    // Only positions from the current token onwards are kept. Entries are keyed by address, so they are only kept while
+    // each token starts where the last one ended in the same input
+    struct MunchMemo{
+        // Input position of the first kept entry, and the # of DFA states per position
+        const char* base = NULL;
+        int states = 0;
+        // End of the input the entries were found in, and where the last simulation's token ended
+        const char* end = NULL;
+        const char* tokenEnd = NULL;
+        // Fill of the stream buffer the entries were found in, since a buffer can move by a fill and still line up with
+        // them. 0 for other input
+        unsigned long long fill = 0;
+        // Failed flags indexed by offset + (position - base) * states + state. Entries before offset have been dropped
+        std::vector<char> failed;
+        size_t offset = 0;
+        // Pairs reached since the last accept of the current simulation, as (position, state)
+        std::vector<std::pair<const char*, int>> trail;
+        // Drops every entry
+        void reset();
+        // Moves the start of the kept entries to the start of a new token. Resets unless the token starts where the last
+        // one ended, or a char after it if it was empty, which is where lexers skip a char no token matches
+        void advance(const char* pos, const char* end, int states, unsigned long long fill = 0);
+        bool isFailed(const char* pos, int state) const;
+        void setFailed(const char* pos, int state);
+    };
+
+    // Counters kept by the lazy DFA cache. Hits and misses count transition lookups
+    struct CacheStats{
+        size_t hits = 0;
+        size_t misses = 0;
+        // Number of times the cache filled up and was emptied
+        size_t flushes = 0;
+        // Number of states currently cached
+        size_t states = 0;
     };
 }
 
+//Automaton used to run a regexp or lexer. Chosen when the object is constructed. Enclosed in special namespace
+namespace Engine{
+    // NFA simulates the Thompson NFA directly, or bit-parallel when its position automaton is small. DFA compiles it into a
+    // transition table first.
+    // LAZYDFA builds DFA states on demand during simulation and caches them in a bounded table.
+    // POSITION simulates the epsilon-free position automaton, which is smaller than a DFA and skips epsilon-only states.
+    // Also bit-parallel when small.
+    // JIT compiles the DFA to machine code on x86-64 Linux, and runs the DFA table elsewhere
+    enum Engine {NFA, DFA, LAZYDFA, POSITION, JIT};
+}
+
+namespace regexp{
+    // Finds the first place a literal occurs in [begin, end). Returns NULL if it doesn't
+    const char* findLiteral(const char* begin, const char* end, const std::string &literal);
+    // Most chars a match may have before the literal a search seeks to. Searches with a longer lead can't seek
+    const int MaxLead = 256;
+    // Compiled lexer function, as made by the JIT engine or generateLexer(). Runs from str, with the input ending at end
+    // or at \0 if end is NULL. Returns the accept value of the longest match, or -1, and sets matchEnd to the end of the match
+    typedef int (*LexFunction)(const char* str, const char* end, const char** matchEnd);
+}
+
 // Custom exception for regexp parsing syntax errors
 class RegexSyntaxError : public std::exception{
     char *str;
@@ -37,10 +137,24 @@ public:
 // Base class for all Regexp based objects. Contains the meat of the Regexp engine, including the NFA
 class BaseRegexp{
 protected:
-    // Regexp NFA, which is a list of states indexed by number
-    std::vector< regexp::State* > nfa;
+    // Regexp NFA, which is a set of arrays indexed by state number
+    regexp::NFA nfa;
     // Index of starting state of NFA
     int starting;
+    // Automaton that simulate() runs
+    Engine::Engine engine = Engine::NFA;
+    // DFA compiled from the NFA. Only built for the DFA and JIT engines
+    regexp::DFA *dfa = NULL;
+    // Machine code compiled from the DFA. Only built for the JIT engine, and left NULL if the platform isn't supported
+    regexp::JitDFA *jit = NULL;
+    // Cache of DFA states. Only built for the LAZYDFA engine, and kept across simulations
+    regexp::LazyDFA *lazy = NULL;
+    // Position automaton made from the NFA. Only built for the POSITION engine
+    regexp::PositionNFA *positions = NULL;
+    // Bit-parallel simulation of the position automaton. Built for the NFA and POSITION engines when the automaton is small
+    regexp::BitNFA *bits = NULL;
+    // Scratch space used by simulations that aren't given a context
+    regexp::MatchContext scratch;
 
     //Internal class containing the functionality for parsing a regex and constructing a NFA
     class RegexpBuilder{
@@ -78,20 +192,77 @@ protected:
         void parseSpecial(std::bitset<NumOfChars>& transition);
         //Runs parser/builder
         void build(char* re, BaseRegexp *rp, int &start, int &accept);
+        //Analysis of the built NFA for literals that every match contains
+        void findLiterals(int start, int accept, std::string &seek, int &lead, std::string &factor);
+        char singleChar(std::vector<int>& states, int accept);
+        void followLiteral(std::vector<int>& states, int accept, std::string &literal, std::vector<int>& listids, int &id);
+        bool reachableWithout(int start, int accept, int avoid);
+        int leadTo(int start, int target);
     };
 
-    //Functions for simulating the NFA through an input
-    void addState(int state, std::vector<int>& curStates, int *listids, int id);
-    virtual int isAccepting(int state) = 0;
+    //Functions for simulating the NFA through an input. The versions taking a context don't modify the regexp
+    void addState(int state, std::vector<int>& curStates, long long *listids, long long id) const;
+    virtual int isAccepting(int state) const = 0;
+    //Input ends at end, or at \0 if end is NULL. hitEnd is set to whether the scan was still going when it reached end,
+    //in which case more input could make the match longer
+    int simulateNFA(char* &str, regexp::MatchContext &context, const char* end = NULL, bool *hitEnd = NULL) const;
+    int simulate(char* &str, regexp::MatchContext &context, const char* end = NULL, bool *hitEnd = NULL) const;
     int simulate(char* &str);
+    //Unanchored version of the NFA simulation. Finds the leftmost-longest match in one pass over the input
+    //A non-empty literal that every match contains, at most lead chars after its start, lets the search skip to lead
+    //chars before the next place it occurs whenever no match is in progress
+    int searchNFA(char* &str, ptrdiff_t &length, regexp::MatchContext &context, const char* end = NULL,
+        const std::string &literal = std::string(), int lead = 0) const;
+    void addThread(int state, ptrdiff_t start, std::vector<int>& states, ptrdiff_t *starts, long long *listids, long long id,
+        bool relist) const;
+    //Builds the automaton of the selected engine once the NFA is complete
+    void compile(Engine::Engine engine);
+    //Helpers for building DFA states out of NFA state sets
+    void closure(std::vector<int>& states, std::vector<int>& listids, int id) const;
+    int setAccept(std::vector<int>& states) const;
+    int charClasses(unsigned char *classMap) const;
+    //Lays out the finished NFA for simulation. Subclasses renumber their accept states with newNum
+    void layout(std::vector<int>& newNum);
     //Destructor and constructor
-    ~BaseRegexp();
+    virtual ~BaseRegexp();
     BaseRegexp(){}
     friend RegexpBuilder;
+    friend regexp::DFA;
+    friend regexp::LazyDFA;
+    friend regexp::PositionNFA;
+    friend regexp::BitNFA;
     friend std::ostream& operator<<(std::ostream& os, const BaseRegexp& regexp);
     //Disable copying and reassigning
     BaseRegexp(BaseRegexp&) = delete;
     BaseRegexp& operator=(BaseRegexp&) = delete;
+
+public:
+    //Lazy DFA cache counters and size limit, used to size the cache for a particular set of regexps
+    regexp::CacheStats cacheStats();
+    void cacheLimit(size_t states);
+};
+
+class Regexp;
+
+// Iterates over the non-overlapping matches of a regexp in a string, from left to right
+class RegexpMatches{
+private:
+    const Regexp *re;
+    // Where the next search starts, and the end of input (NULL for \0)
+    char *curpos;
+    const char *end;
+    regexp::MatchContext context;
+    // Current match
+    char *matchStart = NULL;
+    ptrdiff_t matchLength = -1;
+
+public:
+    RegexpMatches(const Regexp *re, char *str, const char *end);
+    //Moves to the next match. Returns false once there are no more
+    bool next();
+    //Start and # of chars of the current match
+    char *start();
+    ptrdiff_t length();
 };
 
 // Class representing a single regexp. Included functions for matching and searching through strings
@@ -99,14 +270,33 @@ class Regexp: public BaseRegexp{
 private:
     //Single accepting state of the regexp
     int accepting;
-    int isAccepting(int state);
+    //Literals that every match contains. Either may be empty. Search seeks to the seek literal, which is at most lead
+    //chars into a match, and only starts the NFA from there. The factor is the longest such literal. When it is longer
+    //than the seek literal, it only rejects input that lacks it before the NFA runs, since a match could start anywhere
+    //before it
+    std::string seek;
+    int lead = 0;
+    std::string factor;
+    int isAccepting(int state) const;
 
 public:
-    //Match and search a string for the constructed regexp by simulating NFA
-    int match(char* str);
-    int search(char* &str);
-    //Constructors. Builds NFA
-    Regexp(char* re);
+    //Match and search a string for the constructed regexp by simulating NFA. Lengths are ptrdiff_t so that matches in
+    //inputs over 2GB, such as a mapped file, don't overflow
+    ptrdiff_t match(char* str);
+    ptrdiff_t search(char* &str);
+    //Same as above, with caller-owned scratch space and an optional end of input. Doesn't modify the regexp
+    ptrdiff_t search(char* &str, regexp::MatchContext &context, const char* end = NULL) const;
+    //Returns an iterator over every non-overlapping match in the string
+    RegexpMatches searchAll(char* str, const char* end = NULL) const;
+    //Same as above for input that isn't \0-terminated, such as a mapped file or a network buffer. A \0 inside the input
+    //ends a match but not the input. Searching with a string_view drops the chars before the match from the view
+    ptrdiff_t match(const char* begin, const char* end);
+    ptrdiff_t match(std::string_view str);
+    ptrdiff_t search(const char* &begin, const char* end);
+    ptrdiff_t search(std::string_view &str);
+    RegexpMatches searchAll(std::string_view str) const;
+    //Constructors. Builds NFA, then the automaton of the selected engine
+    Regexp(char* re, Engine::Engine engine = Engine::NFA);
     Regexp();
     friend std::ostream& operator<<(std::ostream& os, const Regexp& regexp);
 };
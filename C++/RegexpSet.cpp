@@ -0,0 +1,217 @@
+#include "RegexpSet.h"
+#include <algorithm>
+
+//Same construction as the Lexer, alternating every regexp into one NFA and keeping each one's accept state
+RegexpSet::RegexpSet(char* regexplist[], int len, Anchor::Anchor anchor){
+    this->anchor = anchor;
+    count = len;
+    if (len == 0){
+        acceptTable = new int[0];
+        classCount = 0;
+        return;
+    }
+    int* acceptList = new int[len];
+    RegexpBuilder builder;
+    builder.build(regexplist[0], this, starting, acceptList[0]);
+    for (int i=1; i<len; i++){
+        int startR, acceptR;
+        RegexpBuilder builder;
+        builder.build(regexplist[i], this, startR, acceptList[i]);
+        acceptR = acceptList[i];
+        builder.alternate(startR, acceptR, starting, acceptList[i-1]);
+        nfa.pop_back();
+        starting = startR;
+    }
+    std::vector<int> newNum;
+    layout(newNum);
+    acceptTable = new int[nfa.size()];
+    for (int i=0; i<nfa.size(); i++)
+        acceptTable[i] = -1;
+    for (int i=0; i<len; i++)
+        acceptTable[newNum[acceptList[i]]] = i;
+    delete[] acceptList;
+
+    classCount = charClasses(classMap);
+    listids.assign(nfa.size(), -1);
+}
+
+RegexpSet::~RegexpSet(){
+    delete[] acceptTable;
+}
+
+int RegexpSet::isAccepting(int state) const{
+    return acceptTable[state];
+}
+
+int RegexpSet::size() const{
+    return count;
+}
+
+//A new state records every regexp its set accepts, rather than just the lowest one like the DFA engines
+int RegexpSet::findState(){
+    auto found = stateNums.find(states);
+    if (found != stateNums.end())
+        return found->second;
+    if (stateSets.size() >= limit)
+        return -1;
+    int num = stateSets.size();
+    std::vector<int> matches;
+    for (int state : states){
+        if (acceptTable[state] > -1)
+            matches.push_back(acceptTable[state]);
+    }
+    std::sort(matches.begin(), matches.end());
+    stateMatches.push_back(matches);
+    transitions.resize(transitions.size() + classCount, -2);
+    //The \0 class never has transitions
+    transitions[num*classCount + classMap[0]] = -1;
+    taken.push_back(-1);
+    stateNums[states] = num;
+    stateSets.push_back(states);
+    return num;
+}
+
+//A full cache is emptied to make room, so the starting state can always be returned
+int RegexpSet::startState(){
+    if (start < 0){
+        states.clear();
+        states.push_back(starting);
+        closure(states, listids, ++id);
+        start = findState();
+        if (start < 0){
+            flush();
+            start = findState();
+        }
+    }
+    return start;
+}
+
+//Follows the char edges of every NFA state in the set, then closes the result. Unanchored sets restart every regexp at
+//every char, so the starting state joins every set
+int RegexpSet::computeTransition(int state, int cls){
+    int c = 1;
+    while (classMap[c] != cls)
+        c++;
+    states.clear();
+    id++;
+    for (int nfaState : stateSets[state]){
+        int edge = nfa.edge[nfaState];
+        if (nfa.transitions(nfaState)[c] && listids[edge] != id){
+            listids[edge] = id;
+            states.push_back(edge);
+        }
+    }
+    if (anchor == Anchor::NONE && listids[starting] != id){
+        listids[starting] = id;
+        states.push_back(starting);
+    }
+    int next = -1;
+    if (!states.empty()){
+        closure(states, listids, id);
+        next = findState();
+        if (next < 0)
+            return -2;
+    }
+    transitions[state*classCount + cls] = next;
+    return next;
+}
+
+void RegexpSet::flush(){
+    transitions.clear();
+    stateMatches.clear();
+    stateSets.clear();
+    stateNums.clear();
+    taken.clear();
+    start = -1;
+    counters.flushes++;
+}
+
+int RegexpSet::take(int state, std::vector<char> &hits){
+    if (taken[state] == scan)
+        return 0;
+    taken[state] = scan;
+    int found = 0;
+    for (int match : stateMatches[state]){
+        found += !hits[match];
+        hits[match] = 1;
+    }
+    return found;
+}
+
+//One transition per char. Anchored scans end when the DFA dies, and unanchored ones once every regexp has matched.
+//Regexps anchored at both ends only count in the state the input ends in
+int RegexpSet::match(const char* str, const char* end, std::vector<char> &hits){
+    hits.assign(count, 0);
+    if (count == 0)
+        return 0;
+    int found = 0;
+    scan++;
+    int state = startState();
+    if (anchor != Anchor::BOTH)
+        found += take(state, hits);
+    for (ptrdiff_t i=0; found < count; i++){
+        if ((end == NULL) ? str[i] == 0 : str+i == end){
+            if (anchor == Anchor::BOTH)
+                found += take(state, hits);
+            break;
+        }
+        unsigned char c = str[i];
+        //Chars outside the alphabet, and \0 in bounded input, have no transitions, which only leaves the restarted regexps
+        int next;
+        if (c == 0 || c >= NumOfChars)
+            next = (anchor == Anchor::NONE) ? startState() : -1;
+        else{
+            int cls = classMap[c];
+            next = transitions[state*classCount + cls];
+            if (next == -2){
+                counters.misses++;
+                next = computeTransition(state, cls);
+                //A full cache is emptied and the current state cached again by itself
+                if (next == -2){
+                    std::vector<int> current = stateSets[state];
+                    flush();
+                    states = current;
+                    state = findState();
+                    next = computeTransition(state, cls);
+                }
+            }
+            else counters.hits++;
+        }
+        if (next < 0)
+            break;
+        state = next;
+        if (anchor != Anchor::BOTH)
+            found += take(state, hits);
+    }
+    return found;
+}
+
+std::vector<int> RegexpSet::match(const char* str, const char* end){
+    std::vector<char> hits;
+    match(str, end, hits);
+    std::vector<int> matches;
+    for (int i=0; i<count; i++){
+        if (hits[i])
+            matches.push_back(i);
+    }
+    return matches;
+}
+
+std::vector<int> RegexpSet::match(std::string_view str){
+    //An empty view may have no data, and a NULL end would mean \0-terminated input
+    if (str.empty())
+        str = std::string_view("", 0);
+    return match(str.data(), str.data() + str.size());
+}
+
+regexp::CacheStats RegexpSet::cacheStats(){
+    regexp::CacheStats current = counters;
+    current.states = stateSets.size();
+    return current;
+}
+
+//Unanchored scans need room for a state and the one it moves to
+void RegexpSet::cacheLimit(size_t states){
+    limit = std::max(states, (size_t)2);
+    flush();
+}
@@ -0,0 +1,76 @@
+#ifndef REGEXPSET_H
+#define REGEXPSET_H
+
+#include "Regexp.h"
+#include <vector>
+#include <map>
+#include <string_view>
+
+//Where the patterns of a RegexpSet have to match. Enclosed in special namespace
+namespace Anchor{
+    // NONE reports patterns matching anywhere in the input, START ones matching a prefix of it, and BOTH ones matching all of it
+    enum Anchor {NONE, START, BOTH};
+}
+
+// Many independent regexps checked against an input at once. The regexps are built into one NFA with an accept state each,
+// the same way a Lexer is, and a DFA whose states remember every regexp they accept is built from it on demand.
+// One pass over the input then finds every regexp that matches, however many there are.
+// The DFA cache is bounded and flushed when full, like the LAZYDFA engine. Matching fills the cache, so a set can't be
+// used by several threads at once
+class RegexpSet : public BaseRegexp{
+private:
+    //Number of the regexp accepted by each NFA state, -1 for none
+    int* acceptTable;
+    int count;
+    Anchor::Anchor anchor;
+    //Char classes of the NFA, same as the ones used by the DFA engines
+    unsigned char classMap[NumOfChars];
+    int classCount;
+    //Cached DFA. Transitions are indexed by state * classCount + char class. -1 means no transition, -2 means not computed yet
+    std::vector<int> transitions;
+    //Regexps accepted by each cached state, in order
+    std::vector<std::vector<int>> stateMatches;
+    //NFA state set of each cached state, and the map used to find a state by its set
+    std::vector<std::vector<int>> stateSets;
+    std::map<std::vector<int>, int> stateNums;
+    //Cached starting state, -1 if it isn't cached
+    int start = -1;
+    //Last scan that took each state's matches, so a scan takes them once however often it passes through the state
+    std::vector<int> taken;
+    int scan = 0;
+    size_t limit = 4096;
+    regexp::CacheStats counters;
+    //Scratch space for computing state sets
+    std::vector<int> listids;
+    std::vector<int> states;
+    int id = 0;
+
+    int isAccepting(int state) const;
+    //Returns the cached state for the closed set held in states. Returns -1 if the cache is full
+    int findState();
+    //Computes the transition of a cached state for a char class. Returns -2 if the cache is full
+    int computeTransition(int state, int cls);
+    //Returns the starting state, caching it if needed
+    int startState();
+    //Empties the cache
+    void flush();
+    //Adds the regexps accepted by a state to hits. Returns the # that weren't there already
+    int take(int state, std::vector<char> &hits);
+
+public:
+    //Builds the NFA of every regexp in the list. Regexps are reported by their index in the list
+    RegexpSet(char* regexplist[], int len, Anchor::Anchor anchor = Anchor::NONE);
+    ~RegexpSet();
+    //# of regexps in the set
+    int size() const;
+    //Returns the indices of every regexp that matches the input, in order. The input ends at end, or at \0 if end is NULL
+    std::vector<int> match(const char* str, const char* end = NULL);
+    std::vector<int> match(std::string_view str);
+    //Same as above, setting hits to an on/off array indexed by regexp number. Returns the # of regexps that matched
+    int match(const char* str, const char* end, std::vector<char> &hits);
+    //DFA cache counters and size limit
+    regexp::CacheStats cacheStats();
+    void cacheLimit(size_t states);
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "Lexer.h"
+#include <atomic>
+#include <new>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+//Allocation check of the lexer. Replaces the global operator new with one that counts calls, then lexes the same input
+//twice with each engine and one LexContext. The first pass grows the context's buffers and fills caches. The second is
+//the steady state and should allocate nothing. Usage: lexallocs [# of copies of the sample input]
+//Prints the allocations per token of each engine and returns 1 if the steady state allocated
+
+static std::atomic<size_t> allocations(0);
+
+void* operator new(size_t size){
+    allocations++;
+    void *p = malloc(size > 0 ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size){
+    return operator new(size);
+}
+void operator delete(void* p) noexcept{
+    free(p);
+}
+void operator delete[](void* p) noexcept{
+    free(p);
+}
+void operator delete(void* p, size_t) noexcept{
+    free(p);
+}
+void operator delete[](void* p, size_t) noexcept{
+    free(p);
+}
+
+//Lexes the whole input the way tokenizeAll() does without storing the tokens. Returns the # of tokens
+static size_t lexAll(const Lexer &lexer, LexContext &context, const std::string &input){
+    const char *end = input.data() + input.size();
+    char *pos = (char*)input.data();
+    size_t tokens = 0;
+    while (pos < end){
+        char *next = lexer.lex(pos, context, end);
+        pos = (next == pos) ? pos+1 : next;
+        tokens++;
+    }
+    return tokens;
+}
+
+//One lexer to check. Keyword lexers list every C++ keyword before the identifier regexp, which makes the NFA too big to
+//run bit-parallel. With fold set the keywords are found by the keyword table instead
+struct Run{
+    const char *name;
+    Engine::Engine engine;
+    bool linear;
+    bool keywords;
+    bool fold;
+};
+
+int main(int argc, char* argv[]){
+    int copies = (argc > 1) ? atoi(argv[1]) : 1000;
+    const char *keywords[] = {"alignas", "alignof", "auto", "bool", "break", "case", "catch", "char", "class", "const",
+        "constexpr", "continue", "decltype", "default", "delete", "do", "double", "else", "enum", "explicit", "extern",
+        "false", "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept",
+        "nullptr", "operator", "private", "protected", "public", "return", "short", "signed", "sizeof", "static",
+        "struct", "switch", "template", "this", "throw", "true", "try", "typedef", "typename", "union", "unsigned",
+        "using", "virtual", "void", "volatile", "while"};
+    const char *tokens[] = {"[a-zA-Z_][a-zA-Z_0-9]*", "[0-9]+(.[0-9]+)?", "\"([^\"]|\\\\\")*\"",
+        "==|=|\\+|-|\\*|/|;|,|\\(|\\)|{|}", "[ \t\n]+"};
+    std::vector<char*> small = {(char*)"if", (char*)"while", (char*)"return"};
+    std::vector<char*> large;
+    for (const char *keyword : keywords)
+        large.push_back((char*)keyword);
+    for (const char *token : tokens){
+        small.push_back((char*)token);
+        large.push_back((char*)token);
+    }
+    std::string input;
+    for (int i=0; i<copies; i++)
+        input += "while (x1 == 42) { y = f(\"str\", 3.14) + x1; if (y) return y; else continue; }\n";
+
+    Run runs[] = {{"NFA", Engine::NFA, false, false, true}, {"DFA", Engine::DFA, false, false, true},
+        {"LAZYDFA", Engine::LAZYDFA, false, false, true}, {"POSITION", Engine::POSITION, false, false, true},
+        {"JIT", Engine::JIT, false, false, true}, {"DFA linear", Engine::DFA, true, false, true},
+        {"NFA keywords", Engine::NFA, false, true, false}, {"POSITION keywords", Engine::POSITION, false, true, false},
+        {"DFA folded keywords", Engine::DFA, false, true, true}};
+    int failed = 0;
+    for (const Run &run : runs){
+        std::vector<char*> &regexps = run.keywords ? large : small;
+        Lexer lexer(regexps.data(), regexps.size(), -1, run.engine, run.fold);
+        if (run.linear)
+            lexer.linearMunch(true);
+        LexContext context;
+        lexAll(lexer, context, input);
+        size_t before = allocations;
+        size_t count = lexAll(lexer, context, input);
+        size_t used = allocations - before;
+        printf("%-20s %zu tokens, %zu allocations, %.4f per token\n", run.name, count, used, (double)used / count);
+        failed += used > 0;
+    }
+    return failed > 0;
+}
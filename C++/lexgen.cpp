@@ -0,0 +1,40 @@
+#include "LexerGenerator.h"
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+//Command line front end of generateLexer(). Usage: lexgen [-o output.cpp] function_name regexp...
+//Regexps are numbered in the order given. Output goes to stdout unless -o is given
+int main(int argc, char* argv[]){
+    const char *output = NULL;
+    int arg = 1;
+    if (arg+1 < argc && strcmp(argv[arg], "-o") == 0){
+        output = argv[arg+1];
+        arg += 2;
+    }
+    if (arg >= argc){
+        std::cerr << "Usage: " << argv[0] << " [-o output.cpp] function_name regexp...\n";
+        return 1;
+    }
+    std::string name = argv[arg++];
+    //The file is only written once generation succeeds
+    std::ostringstream source;
+    try{
+        generateLexer(argv+arg, argc-arg, name, source);
+    }
+    catch (RegexSyntaxError &e){
+        std::cerr << '\n';
+        return 1;
+    }
+    if (output == NULL){
+        std::cout << source.str();
+        return 0;
+    }
+    std::ofstream out(output);
+    if (!out){
+        std::cerr << "Cannot open " << output << '\n';
+        return 1;
+    }
+    out << source.str();
+    return 0;
+}
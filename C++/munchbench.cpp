@@ -0,0 +1,129 @@
+#include "Lexer.h"
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+//Regression benchmark of linear-time maximal munch. The input is words split by escaped quotes, as if a string had been
+//left open. Every quote starts a string token whose escapes never let it close, so the scan runs to the end of the input
+//before falling back to the one char quote token. Plain maximal munch takes quadratic time on it, and linearMunch()
+//should take linear time.
+//Usage: munchbench [largest input size]. Input sizes double from 4K up to the largest, which defaults to 4M.
+//Prints the time per char of each size and returns 1 if the linear lexer's time per char grew by more than 4 times from
+//64K on, where sizes are large enough to time reliably.
+//Also checks that a context reused for new input at the same addresses lexes it the same as a fresh context, and returns
+//1 if it doesn't
+
+//Lexes the whole input and returns the time it took in seconds
+static double lexAll(const Lexer &lexer, const std::string &input){
+    LexContext context;
+    const char *end = input.data() + input.size();
+    char *pos = (char*)input.data();
+    auto start = std::chrono::steady_clock::now();
+    while (pos < end){
+        char *next = lexer.lex(pos, context, end);
+        pos = (next == pos) ? pos+1 : next;
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//Failed pairs are kept by address, so they must not carry over to new input written where old input was. Lexes input
+//in a buffer, then new input over part of it with the same context, and again with a stream whose buffer the caller
+//refills between tokens. Returns the # of tokens that differ from a fresh lex
+static int reusedContext(){
+    char* regexps[] = {(char*)"a*b", (char*)"a", (char*)" "};
+    Lexer lexer(regexps, 3, -1, Engine::DFA);
+    lexer.linearMunch(true);
+    int failed = 0;
+
+    //The first token's scan marks the a's after it as failed, which they no longer are once the b is written
+    char buffer[] = "aaaaaaaa";
+    LexContext context;
+    lexer.lex(buffer, context, buffer+8);
+    memcpy(buffer+1, "aab", 3);
+    LexContext fresh;
+    char *reused = lexer.lex(buffer+1, context, buffer+4);
+    char *expected = lexer.lex(buffer+1, fresh, buffer+4);
+    if (reused != expected || context.tokenID != fresh.tokenID){
+        printf("Reused context lexed \"aab\" as token %d of length %td, expected token %d of length %td\n",
+            context.tokenID, reused - (buffer+1), fresh.tokenID, expected - (buffer+1));
+        failed++;
+    }
+
+    std::mt19937 rng(1);
+    for (int trial=0; trial<200; trial++){
+        std::string input;
+        for (int n = rng()%200; n > 0; n--)
+            input += "aab c"[rng() % 5];
+        TokenStream tokens = lexer.tokenizeAll(input.data(), input.data() + input.size());
+        size_t read = 0;
+        InputStream stream([&](char* out, size_t size) -> long long{
+            size = std::min(size, std::min((size_t)3, input.size() - read));
+            memcpy(out, input.data() + read, size);
+            read += size;
+            return size;
+        }, 4);
+        LexContext streamContext;
+        char *pos = stream.begin();
+        for (size_t k=0; ; k++){
+            if (rng()%3 == 0)
+                pos = stream.fill(pos);
+            char *next = lexer.lex(stream, pos, streamContext);
+            if (pos == stream.end() && stream.atEOF())
+                break;
+            int id = streamContext.tokenID;
+            if (id < 0 || next == pos){
+                id = -1;
+                next++;
+            }
+            if (k >= tokens.size() || tokens.ids[k] != id || tokens.starts[k] != stream.offset(pos) ||
+                tokens.lengths[k] != next - pos){
+                printf("Stream refilled by the caller lexed token %zu of \"%s\" differently\n", k, input.c_str());
+                failed++;
+                break;
+            }
+            pos = next;
+        }
+    }
+    return failed;
+}
+
+int main(int argc, char* argv[]){
+    size_t largest = (argc > 1) ? atol(argv[1]) : 1 << 22;
+    //Plain maximal munch is only run up to this size, past which it takes too long to be worth waiting for. Linear times
+    //are compared from here on
+    const size_t plainLimit = 1 << 16;
+    char* regexps[] = {(char*)"\"([^\"\\\\]|\\\\.)*\"", (char*)"\"", (char*)"\\\\", (char*)"[a-z]+", (char*)" +"};
+    Lexer plain(regexps, 5, -1, Engine::DFA);
+    Lexer linear(regexps, 5, -1, Engine::DFA);
+    linear.linearMunch(true);
+
+    printf("%10s %16s %16s\n", "chars", "plain ns/char", "linear ns/char");
+    double first = 0, last = 0;
+    for (size_t size = 1 << 12; size <= largest; size *= 2){
+        std::string input;
+        while (input.size() < size)
+            input += "\\\" ab cd ";
+        input.resize(size);
+        double plainTime = (size <= plainLimit) ? lexAll(plain, input) : -1;
+        double linearTime = lexAll(linear, input);
+        double perChar = linearTime * 1e9 / size;
+        if (size >= plainLimit){
+            if (first == 0)
+                first = perChar;
+            last = perChar;
+        }
+        if (plainTime < 0)
+            printf("%10zu %16s %16.2f\n", size, "-", perChar);
+        else printf("%10zu %16.2f %16.2f\n", size, plainTime * 1e9 / size, perChar);
+    }
+    if (last > first * 4){
+        printf("Linear munch time per char grew from %.2fns to %.2fns\n", first, last);
+        return 1;
+    }
+    if (reusedContext() > 0)
+        return 1;
+    return 0;
+}
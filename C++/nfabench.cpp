@@ -0,0 +1,43 @@
+#include "Lexer.h"
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+//Micro-benchmark of the NFA engine's state layout. Runs tokenizeAll() with Engine::NFA over generated C-like input
+//made of 20 kinds of token, lexed by 21 regexps. Usage: nfabench [# of MB of input] [# of runs]
+//Prints the best time of the runs. The input is the same for every build, so building this at the commit that made the
+//NFA flat and at the one before it compares the two layouts
+
+int main(int argc, char* argv[]){
+    size_t size = ((argc > 1) ? atol(argv[1]) : 4) * 1000000;
+    int runs = (argc > 2) ? atoi(argv[2]) : 5;
+    char* regexps[] = {(char*)"[a-zA-Z_][a-zA-Z_0-9]*", (char*)"[0-9]+(.[0-9]+)?", (char*)"\"([^\"]|\\\\\")*\"",
+        (char*)" +", (char*)"\n", (char*)"if", (char*)"else", (char*)"while", (char*)"return", (char*)"for", (char*)"==",
+        (char*)"=", (char*)"\\+", (char*)"-", (char*)"\\*", (char*)"/", (char*)"\\(", (char*)"\\)", (char*)"{",
+        (char*)"}", (char*)";"};
+    Lexer lexer(regexps, 21, 4, Engine::NFA);
+
+    const char *words[] = {"if", "else", "while", "x1", "foo_bar", "123", "4.5", "\"str ing\"", " ", "\n", "==", "=",
+        "+", "(", ")", "{", "}", ";", "return", "for"};
+    std::mt19937 rng(3);
+    std::string input;
+    while (input.size() < size){
+        input += words[rng() % 20];
+        input += ' ';
+    }
+
+    double best = -1;
+    size_t tokens = 0;
+    for (int run=0; run<runs; run++){
+        auto start = std::chrono::steady_clock::now();
+        TokenStream stream = lexer.tokenizeAll(input.data(), input.data() + input.size());
+        double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        tokens = stream.size();
+        if (best < 0 || time < best)
+            best = time;
+    }
+    printf("%zu chars, %zu tokens, best of %d runs: %.1fms\n", input.size(), tokens, runs, best);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "Regexp.h"
+#include <random>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+//Regression check of Regexp::search. Compares the one-pass leftmost-longest search against matching at every offset in
+//turn, on random regexps and inputs over a small alphabet. Usage: searchcheck [# of cases] [seed]
+//Prints the mismatches and returns 1 if there are any
+
+static std::mt19937 rng;
+
+//Random regexp over a, b, c and . with nesting bounded by depth
+static std::string randomRegexp(int depth){
+    switch (rng() % (depth > 3 ? 4 : 9)){
+        case 0: return "a";
+        case 1: return "b";
+        case 2: return "c";
+        case 3: return ".";
+        case 4: return randomRegexp(depth+1) + randomRegexp(depth+1);
+        case 5: return "(" + randomRegexp(depth+1) + "|" + randomRegexp(depth+1) + ")";
+        case 6: return "(" + randomRegexp(depth+1) + ")+";
+        case 7: return "(" + randomRegexp(depth+1) + ")*";
+        default: return "(" + randomRegexp(depth+1) + ")?";
+    }
+}
+
+//Returns false and prints both results if the search disagrees with the per-offset match. Input must not be empty,
+//since searches don't start a match at the end of input
+static bool check(const std::string &re, const std::string &input){
+    Regexp regexp((char*)re.c_str());
+    const char *begin = input.data();
+    const char *end = begin + input.size();
+    int wantStart = -1, wantLength = -1;
+    for (int i=0; i<=(int)input.size() && wantStart == -1; i++){
+        wantLength = regexp.match(begin+i, end);
+        if (wantLength >= 0)
+            wantStart = i;
+    }
+    std::string_view view(input);
+    int length = regexp.search(view);
+    int start = (length < 0) ? -1 : view.data() - begin;
+    if (start == wantStart && (start == -1 || length == wantLength))
+        return true;
+    printf("/%s/ on \"%s\": search gives start %d length %d, expected start %d length %d\n", re.c_str(), input.c_str(),
+        start, length, wantStart, wantLength);
+    return false;
+}
+
+int main(int argc, char* argv[]){
+    int cases = (argc > 1) ? atoi(argv[1]) : 20000;
+    rng.seed((argc > 2) ? atoi(argv[2]) : 1);
+    int failed = 0;
+    //Matches that used to lose states to later starts
+    failed += !check("(a.+.+)", "baacaccacc");
+    failed += !check("c.+()+", "ccbac");
+    //Matches that start up to a few chars before the literal the search seeks to
+    failed += !check("(a|bb)?cab", "cabbcacabbcab");
+    failed += !check("(a|b|c)?(a|b|c)?bca", "abcbcabca");
+    for (int i=0; i<cases; i++){
+        std::string re = randomRegexp(0);
+        std::string input;
+        for (int n = 1 + rng()%12; n > 0; n--)
+            input += "abc"[rng() % 3];
+        failed += !check(re, input);
+    }
+    printf("%d of %d cases failed\n", failed, cases+4);
+    return failed > 0;
+}